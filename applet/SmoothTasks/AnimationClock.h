@@ -0,0 +1,53 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_ANIMATIONCLOCK_H
+#define SMOOTHTASKS_ANIMATIONCLOCK_H
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+namespace SmoothTasks {
+
+// The time source of the animations. Only the differences between two
+// readings are used, so the clock may start at any value.
+class AnimationClock {
+
+public:
+	virtual ~AnimationClock() {}
+
+	// milliseconds since the reference point of the clock
+	virtual qint64 now() const = 0;
+};
+
+// The default clock. Unlike the wall clock it does not jump with NTP or
+// daylight saving time changes and does not wrap at midnight.
+class MonotonicAnimationClock : public AnimationClock {
+
+public:
+	MonotonicAnimationClock();
+
+	qint64 now() const;
+
+private:
+	QElapsedTimer m_timer;
+};
+
+} // namespace SmoothTasks
+#endif
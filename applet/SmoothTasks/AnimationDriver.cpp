@@ -0,0 +1,355 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "SmoothTasks/AnimationDriver.h"
+#include "SmoothTasks/WakeupMonitor.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <limits>
+
+namespace SmoothTasks {
+
+static AnimationDriver *s_driver = NULL;
+
+static void deleteDriver() {
+	delete s_driver;
+	s_driver = NULL;
+}
+
+AnimationDriver *AnimationDriver::self() {
+	if (s_driver == NULL) {
+		s_driver = new AnimationDriver();
+		qAddPostRoutine(deleteDriver);
+	}
+
+	return s_driver;
+}
+
+AnimationDriver::AnimationDriver()
+		: QObject(),
+		  m_timer(new QTimer(this)),
+		  m_monotonicClock(),
+		  m_clock(&m_monotonicClock),
+		  m_fps(25),
+		  m_nextId(1),
+		  m_ticking(false),
+		  m_stoppedCount(0),
+		  m_ids(),
+		  m_types(),
+		  m_receivers(),
+		  m_starts(),
+		  m_durations(),
+		  m_intervals(),
+		  m_frames(),
+		  m_animationMethods(),
+		  m_finishedMethods() {
+	m_timer->setInterval(1000 / m_fps);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+	WakeupMonitor::self()->watch(m_timer, "AnimationDriver");
+}
+
+void AnimationDriver::setClock(AnimationClock *clock) {
+	m_clock = clock ? clock : &m_monotonicClock;
+}
+
+// Looks up the slot once, so the frames don't have to parse signatures.
+int AnimationDriver::animationMethod(QObject *receiver, const char *slot, const char *arguments, const char *caller) const {
+	if (receiver == NULL || slot == NULL) {
+		qWarning("AnimationDriver::%s: receiver and slot are required", caller);
+		return -1;
+	}
+
+	const QMetaObject *meta = receiver->metaObject();
+	const int method = meta->indexOfMethod((QByteArray(slot) + arguments).constData());
+
+	if (method == -1) {
+		qWarning("AnimationDriver::%s: no slot %s::%s%s", caller, meta->className(), slot, arguments);
+	}
+
+	return method;
+}
+
+int AnimationDriver::start(int duration, int fps, QObject *receiver, const char *animationSlot, const char *finishedSlot) {
+	const int method         = animationMethod(receiver, animationSlot, "(qreal)", "start");
+	int       finishedMethod = -1;
+
+	if (method == -1) {
+		return 0;
+	}
+
+	if (finishedSlot != NULL) {
+		finishedMethod = animationMethod(receiver, finishedSlot, "(int)", "start");
+
+		if (finishedMethod == -1) {
+			return 0;
+		}
+	}
+
+	return addTrack(Timed, qMax(duration, 1), fps, receiver, method, finishedMethod);
+}
+
+int AnimationDriver::startBeat(int period, int fps, QObject *receiver, const char *animationSlot) {
+	const int method = animationMethod(receiver, animationSlot, "(qreal)", "startBeat");
+
+	if (method == -1) {
+		return 0;
+	}
+
+	return addTrack(Beat, qMax(period, 1), fps, receiver, method, -1);
+}
+
+int AnimationDriver::startTicker(int fps, QObject *receiver, const char *tickSlot) {
+	const int method = animationMethod(receiver, tickSlot, "()", "startTicker");
+
+	if (method == -1) {
+		return 0;
+	}
+
+	return addTrack(Ticker, 0, fps, receiver, method, -1);
+}
+
+int AnimationDriver::addTrack(TrackType type, int duration, int fps, QObject *receiver, int animationMethod, int finishedMethod) {
+	if (fps <= 0) {
+		qWarning("AnimationDriver::addTrack: invalid fps %d", fps);
+		fps = 25;
+	}
+
+	const int track    = m_nextId;
+	const int interval = qMax(1000 / fps, 1);
+	m_nextId = m_nextId == std::numeric_limits<int>::max() ? 1 : m_nextId + 1;
+
+	m_ids.append(track);
+	m_types.append(type);
+	m_receivers.append(receiver);
+	// beats are in phase with the clock, not with their start
+	m_starts.append(type == Beat ? 0 : m_clock->now());
+	m_durations.append(duration);
+	m_intervals.append(interval);
+	// called with the next frame, whatever its time
+	m_frames.append(std::numeric_limits<qint64>::min());
+	m_animationMethods.append(animationMethod);
+	m_finishedMethods.append(finishedMethod);
+
+	connect(
+		receiver, SIGNAL(destroyed(QObject*)),
+		this, SLOT(receiverDestroyed(QObject*)),
+		Qt::UniqueConnection);
+
+	if (!m_timer->isActive()) {
+		m_timer->start(interval);
+	}
+	else if (interval < m_timer->interval()) {
+		m_timer->setInterval(interval);
+	}
+	m_fps = 1000 / m_timer->interval();
+
+	return track;
+}
+
+void AnimationDriver::updateInterval() {
+	const int N = m_intervals.size();
+	int interval = std::numeric_limits<int>::max();
+
+	for (int index = 0; index < N; ++ index) {
+		interval = qMin(interval, m_intervals[index]);
+	}
+
+	if (interval != m_timer->interval()) {
+		m_timer->setInterval(interval);
+		m_fps = 1000 / interval;
+	}
+}
+
+// A track slower than the timer is only due once per frame interval of the
+// clock, so all tracks of the same rate are called in the same frames.
+bool AnimationDriver::isDue(int index, qint64 time) {
+	const qint64 frame = time / m_intervals[index];
+
+	if (frame == m_frames[index]) {
+		return false;
+	}
+
+	m_frames[index] = frame;
+	return true;
+}
+
+int AnimationDriver::indexOf(int track) const {
+	if (track == 0) {
+		return -1;
+	}
+
+	const int N = m_ids.size();
+
+	for (int index = 0; index < N; ++ index) {
+		if (m_ids[index] == track) {
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+void AnimationDriver::stop(int track) {
+	const int index = indexOf(track);
+
+	if (index != -1) {
+		markStopped(index);
+
+		if (!m_ticking) {
+			removeStopped();
+		}
+	}
+}
+
+void AnimationDriver::markStopped(int index) {
+	m_ids[index] = 0;
+	++ m_stoppedCount;
+}
+
+void AnimationDriver::removeStopped() {
+	const int N = m_ids.size();
+	int count = 0;
+
+	for (int index = 0; index < N; ++ index) {
+		if (m_ids[index] != 0) {
+			if (count != index) {
+				m_ids[count]              = m_ids[index];
+				m_types[count]            = m_types[index];
+				m_receivers[count]        = m_receivers[index];
+				m_starts[count]           = m_starts[index];
+				m_durations[count]        = m_durations[index];
+				m_intervals[count]        = m_intervals[index];
+				m_frames[count]           = m_frames[index];
+				m_animationMethods[count] = m_animationMethods[index];
+				m_finishedMethods[count]  = m_finishedMethods[index];
+			}
+			++ count;
+		}
+	}
+
+	m_ids.resize(count);
+	m_types.resize(count);
+	m_receivers.resize(count);
+	m_starts.resize(count);
+	m_durations.resize(count);
+	m_intervals.resize(count);
+	m_frames.resize(count);
+	m_animationMethods.resize(count);
+	m_finishedMethods.resize(count);
+	m_stoppedCount = 0;
+
+	if (count == 0) {
+		m_timer->stop();
+	}
+	else {
+		updateInterval();
+	}
+}
+
+void AnimationDriver::tick() {
+	if (m_ticking) {
+		return;
+	}
+
+	const qint64 now = m_clock->now();
+	// half a frame early still counts, so the tracks as fast as the timer
+	// do not skip a frame whenever the timer fires a bit early
+	const qint64 due = now + m_timer->interval() / 2;
+	// tracks started by the slots called below begin with the next frame
+	const int N = m_ids.size();
+	m_ticking = true;
+
+	for (int index = 0; index < N; ++ index) {
+		const int track = m_ids[index];
+
+		if (track == 0 || m_types[index] == Ticker) {
+			continue;
+		}
+
+		const int type            = m_types[index];
+		const int duration        = m_durations[index];
+		const int animationMethod = m_animationMethods[index];
+		const qint64 elapsed      = now - m_starts[index];
+		qreal progress = type == Beat ?
+			qreal(elapsed % duration) / duration :
+			qreal(elapsed) / duration;
+
+		if (progress < 1.0) {
+			if (!isDue(index, due)) {
+				continue;
+			}
+
+			void *args[] = { NULL, &progress };
+			QMetaObject::metacall(m_receivers[index], QMetaObject::InvokeMetaMethod, animationMethod, args);
+		}
+		else {
+			const int finishedMethod = m_finishedMethods[index];
+			progress = 1.0;
+			markStopped(index);
+
+			void *args[] = { NULL, &progress };
+			QMetaObject::metacall(m_receivers[index], QMetaObject::InvokeMetaMethod, animationMethod, args);
+
+			// the receiver might have been deleted by the last frame
+			if (finishedMethod != -1 && m_receivers[index] != NULL) {
+				int finishedTrack = track;
+				void *finishedArgs[] = { NULL, &finishedTrack };
+				QMetaObject::metacall(m_receivers[index], QMetaObject::InvokeMetaMethod, finishedMethod, finishedArgs);
+			}
+		}
+	}
+
+	// the tickers see what the other tracks did in this frame
+	for (int index = 0; index < N; ++ index) {
+		if (m_ids[index] != 0 && m_types[index] == Ticker && isDue(index, due)) {
+			void *args[] = { NULL };
+			QMetaObject::metacall(m_receivers[index], QMetaObject::InvokeMetaMethod, m_animationMethods[index], args);
+		}
+	}
+
+	m_ticking = false;
+
+	if (m_stoppedCount > 0 || m_ids.isEmpty()) {
+		removeStopped();
+	}
+}
+
+void AnimationDriver::receiverDestroyed(QObject *receiver) {
+	const int N = m_ids.size();
+
+	for (int index = 0; index < N; ++ index) {
+		if (m_receivers[index] == receiver) {
+			m_receivers[index] = NULL;
+
+			if (m_ids[index] != 0) {
+				markStopped(index);
+			}
+		}
+	}
+
+	if (!m_ticking) {
+		removeStopped();
+	}
+}
+
+} // namespace SmoothTasks
+#include "AnimationDriver.moc"
@@ -0,0 +1,121 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_ANIMATIONDRIVER_H
+#define SMOOTHTASKS_ANIMATIONDRIVER_H
+
+#include <QObject>
+#include <QVector>
+
+#include "SmoothTasks/AnimationClock.h"
+
+class QTimer;
+
+namespace SmoothTasks {
+
+// Drives every animation of the applet from one timer, so all of them
+// advance together once per frame. A running animation is a track:
+//
+//  * a timed track is passed its linear progress from 0 to 1 and ends
+//    after its duration
+//  * a beat repeats the progress from 0 to 1 every period until it is
+//    stopped. All beats of the same period are in phase, no matter when
+//    they were started, so e.g. all attention pulses go in lockstep.
+//  * a ticker is called once per frame until it is stopped. The tickers
+//    come after the other tracks, so they see the state of the frame.
+//
+// Every track is started with the frame rate of its applet. The timer runs at
+// the rate of the fastest track and slower tracks skip frames. They are called
+// once per frame interval of the clock, so all tracks of the same rate still
+// advance together. The timer only runs while there are tracks.
+//
+// Slots are given by name like for Plasma::Animator: the animation slot of
+// a timed track or beat takes a qreal, the finished slot the int id of the
+// track and the slot of a ticker takes no arguments.
+class AnimationDriver : public QObject {
+	Q_OBJECT
+
+public:
+	// shared by all applets of the process, deleted when the application quits
+	static AnimationDriver *self();
+
+	// Returns the id of the new track, or 0 if the slots don't exist.
+	int  start(int duration, int fps, QObject *receiver, const char *animationSlot, const char *finishedSlot = NULL);
+	int  startBeat(int period, int fps, QObject *receiver, const char *animationSlot);
+	int  startTicker(int fps, QObject *receiver, const char *tickSlot);
+	void stop(int track);
+	bool isActive(int track) const { return indexOf(track) != -1; }
+
+	// the rate of the fastest track, the timer runs at it
+	int  fps() const { return m_fps; }
+
+	// The clock the progress of the tracks is measured with. It is not
+	// owned by the driver, pass NULL to go back to the monotonic clock.
+	AnimationClock *clock() const { return m_clock; }
+	void            setClock(AnimationClock *clock);
+
+	int trackCount() const { return m_ids.size() - m_stoppedCount; }
+
+public slots:
+	// advances all tracks by one frame, called by the timer
+	void tick();
+
+private slots:
+	void receiverDestroyed(QObject *receiver);
+
+private:
+	enum TrackType {
+		Timed,
+		Beat,
+		Ticker
+	};
+
+	AnimationDriver();
+
+	int  indexOf(int track) const;
+	int  animationMethod(QObject *receiver, const char *slot, const char *arguments, const char *caller) const;
+	int  addTrack(TrackType type, int duration, int fps, QObject *receiver, int animationMethod, int finishedMethod);
+	bool isDue(int index, qint64 time);
+	void updateInterval();
+	void markStopped(int index);
+	void removeStopped();
+
+	QTimer                  *m_timer;
+	MonotonicAnimationClock  m_monotonicClock;
+	AnimationClock          *m_clock;
+	int                      m_fps;
+	int                      m_nextId;
+	bool                     m_ticking;
+	int                      m_stoppedCount;
+
+	// The tracks as parallel arrays. Stopped tracks have the id 0 and are
+	// removed once the current frame is done.
+	QVector<int>             m_ids;
+	QVector<char>            m_types; // TrackType
+	QVector<QObject*>        m_receivers;
+	QVector<qint64>          m_starts;
+	QVector<int>             m_durations; // the period of beats
+	QVector<int>             m_intervals; // msecs per frame of the track
+	QVector<qint64>          m_frames;    // the frame the track was last called in
+	QVector<int>             m_animationMethods;
+	QVector<int>             m_finishedMethods; // -1 for none
+};
+
+} // namespace SmoothTasks
+#endif
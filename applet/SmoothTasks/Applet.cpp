@@ -21,6 +21,11 @@
 
 // Smooth Tasks
 #include "SmoothTasks/Applet.h"
+#include "SmoothTasks/CapacityController.h"
+#include "SmoothTasks/RepaintScheduler.h"
+#include "SmoothTasks/FrameRenderer.h"
+#include "SmoothTasks/LabelCache.h"
+#include "SmoothTasks/WakeupMonitor.h"
 #include "SmoothTasks/TaskItem.h"
 #include "SmoothTasks/Task.h"
 #include "SmoothTasks/ByShapeTaskbarLayout.h"
@@ -52,6 +57,7 @@
 #include <KMenu>
 #include <KConfigDialog>
 #include <KWindowSystem>
+#include <KGlobalSettings>
 
 namespace SmoothTasks {
 
@@ -77,12 +83,16 @@ namespace SmoothTasks {
 Applet::Applet(QObject *parent, const QVariantList &args)
 		: Plasma::Applet(parent, args),
 		  m_frame(new Plasma::FrameSvg(this)),
+		  m_frameRenderer(new FrameRenderer(m_frame, this)),
+		  m_labelCache(new LabelCache(this)),
 		  m_groupManager(new GroupManager(this)),
 		  m_rootGroup(m_groupManager->rootGroup()),
 		  m_toolTip(new SmoothToolTip(this)),
 		  m_layout(new LimitSqueezeTaskbarLayout(0.6, false, (formFactor() == Plasma::Vertical) ?
 			Qt::Vertical : Qt::Horizontal,
 			this)),
+		  m_capacityController(new CapacityController(this)),
+		  m_repaintScheduler(new RepaintScheduler(this)),
 		  m_tasksHash(),
 		  m_configG(),
 		  m_configA(),
@@ -184,6 +194,19 @@ void Applet::init() {
 		KWindowSystem::self(), SIGNAL(currentDesktopChanged(int)),
 		this, SLOT(currentDesktopChanged()));
 
+	connect(
+		m_capacityController, SIGNAL(reevaluate()),
+		this, SLOT(updateFullLimit()));
+
+	// the group expanders come from the theme and use the smallest readable
+	// font, neither of which is part of the key of a label
+	connect(
+		m_frame, SIGNAL(repaintNeeded()),
+		m_labelCache, SLOT(clear()));
+	connect(
+		KGlobalSettings::self(), SIGNAL(kdisplayFontChanged()),
+		m_labelCache, SLOT(clear()));
+
 	m_layout->setContentsMargins(0, 0, 0, 0);
 	m_layout->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 	m_layout->setMaximumSize(INT_MAX, INT_MAX);
@@ -225,6 +248,10 @@ void Applet::disconnectRootGroup() {
 
 void Applet::itemAdded(AbstractGroupableItem* groupableItem) {
 //	qDebug("itemAdded: 0x%lx \"%s\"", (unsigned long) groupableItem, qPrintable(groupableItem->name()));
+	itemAdded(groupableItem, m_groupManager->rootGroup()->members().indexOf(groupableItem));
+}
+
+void Applet::itemAdded(AbstractGroupableItem* groupableItem, int index) {
 	if (m_tasksHash.value(groupableItem) != NULL) {
 		qWarning("Applet::itemAdded: item already exist: %s", qPrintable(groupableItem->name()));
 		return;
@@ -244,13 +271,15 @@ void Applet::itemAdded(AbstractGroupableItem* groupableItem) {
 			group, SIGNAL(itemRemoved(AbstractGroupableItem*)),
 			this, SLOT(updateFullLimit()));
 	}
-	
-	int index = m_groupManager->rootGroup()->members().indexOf(groupableItem);
 
 	m_layout->insertItem(index, item, item->isExpanded());
 	m_tasksHash[groupableItem] = item;
-	updateFullLimit();
-	m_layout->activate();
+
+	// when reloading this is done once all items are there
+	if (!m_layout->isBatching()) {
+		updateFullLimit();
+		m_layout->activate();
+	}
 }
 
 void Applet::itemRemoved(AbstractGroupableItem* groupableItem) {
@@ -261,8 +290,10 @@ void Applet::itemRemoved(AbstractGroupableItem* groupableItem) {
 		return;
 	}
 	m_layout->removeItem(item);
-	updateFullLimit();
-	m_layout->activate();
+	if (!m_layout->isBatching()) {
+		updateFullLimit();
+		m_layout->activate();
+	}
 	delete item;
 }
 
@@ -320,8 +351,10 @@ void Applet::itemPositionChanged(AbstractGroupableItem* groupableItem) {
 }
 
 void Applet::clear() {
+	m_layout->beginBatch();
 	m_tasksHash.clear();
 	m_layout->clear(true);
+	m_layout->commitBatch();
 }
 
 void Applet::reload() {
@@ -337,11 +370,17 @@ void Applet::reload() {
 }
 
 void Applet::reloadItems() {
+	m_layout->beginBatch();
 	clear();
 	
+	// the items are added in order, so there is no need to look up their index
 	foreach(AbstractGroupableItem* item, m_groupManager->rootGroup()->members()) {
-		itemAdded(item);
+		itemAdded(item, m_layout->count());
 	}
+
+	m_layout->commitBatch();
+	updateFullLimit();
+	m_layout->activate();
 	KConfigGroup cg = config();
     
     //load launchers
@@ -368,8 +407,14 @@ void Applet::reloadItems() {
 }
 
 void Applet::updateFullLimit() {
-	if (m_groupManager != NULL) {
-		m_groupManager->setFullLimit(m_layout->optimumCapacity());
+	if (m_groupManager == NULL) {
+		return;
+	}
+
+	if (m_capacityController->propose(
+			m_layout->optimumCapacity(), m_layout->count(),
+			m_layout->ungroupedCompression())) {
+		m_groupManager->setFullLimit(m_capacityController->limit());
 	}
 }
 
@@ -561,6 +606,16 @@ void Applet::dumpItems() {
 			<< (allEqual ? "" : "X");
 	}
 
+	qDebug("wakeups in the last second: %s",
+		qPrintable(WakeupMonitor::self()->lastSecond()));
+	const qint64 frames = m_repaintScheduler->frameCount();
+	qDebug("pixmap round trips: %d, uploads: %d, in %lld repainted frames, %.2f round trips per frame",
+		pixmapToImageCount(), imageToPixmapCount(), (long long) frames,
+		frames > 0 ? double(pixmapToImageCount()) / frames : 0.0);
+	qDebug("regroupings: %d, suppressed: %d",
+		m_capacityController->flipCount(),
+		m_capacityController->suppressedCount());
+
 	qDebug("\n");
 }
 
@@ -1246,6 +1301,8 @@ void Applet::configuration() {
 		newLayout->setExpandedWidth(m_layout->expandedWidth());
 		newLayout->setAspectRatio(m_layout->aspectRatio());
 		newLayout->setAnimationsEnabled(m_layout->animationsEnabled());
+		newLayout->setStableSizeHint(m_layout->stableSizeHint());
+		newLayout->setPixelSnapping(m_layout->pixelSnapping());
 
 		newLayout->setContentsMargins(0, 0, 0, 0);
 		newLayout->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -1257,6 +1314,9 @@ void Applet::configuration() {
 
 		m_layout = newLayout;
 		setLayout(m_layout);
+
+		// the new layout computes its capacity differently
+		m_capacityController->reset();
 	}
 
 	int cfgKeepExpanded = cg.readEntry("keepExpanded", (int) ExpandNone);
@@ -1360,6 +1420,9 @@ void Applet::configuration() {
 
 	m_layout->setExpandDuration(cg.readEntry("animationDuration", 175));
 	m_layout->setFps(cg.readEntry("fps", 25));
+	m_repaintScheduler->setFps(m_layout->fps());
+	m_layout->setStableSizeHint(cg.readEntry("stableSizeHint", false));
+	m_layout->setPixelSnapping(cg.readEntry("pixelSnapping", false));
 
 	int cfgSortingStrategy = cg.readEntry("sortingStrategy",
 		static_cast<int>(TaskManager::GroupManager::AlphaSorting));
@@ -68,6 +68,10 @@ class TaskItem;
 class ToolTipBase;
 class TaskbarLayout;
 class GroupManager;
+class CapacityController;
+class RepaintScheduler;
+class FrameRenderer;
+class LabelCache;
 
 class Applet : public Plasma::Applet {
 	Q_OBJECT
@@ -121,8 +125,12 @@ public:
 	IconShapeType     iconShape()             const { return m_shape; }
 	int               fps()                   const;
 	ToolTipBase      *toolTip()                     { return m_toolTip; }
+	RepaintScheduler *repaintScheduler()            { return m_repaintScheduler; }
+	TaskbarLayout    *taskbarLayout()               { return m_layout; }
 	TaskManager::GroupManager *groupManager()       { return m_groupManager; }
 	Plasma::FrameSvg *frame()                       { return m_frame; }
+	FrameRenderer    *frameRenderer()               { return m_frameRenderer; }
+	LabelCache       *labelCache()                  { return m_labelCache; }
 	QRect             currentScreenGeometry() const;
 	QRect             virtualScreenGeometry() const;
 	PreviewLayoutType previewLayout()         const { return m_previewLayout; }
@@ -145,17 +153,22 @@ public:
 	
 private:
 	void reloadItems();
+	void itemAdded(AbstractGroupableItem *groupableItem, int index);
 	void connectRootGroup();
 	void disconnectRootGroup();
 	TaskManager::BasicMenu *popup(Task *task);
 	
 	// other
 	Plasma::FrameSvg                    *m_frame;
+	FrameRenderer                       *m_frameRenderer;
+	LabelCache                          *m_labelCache;
 	TaskManager::GroupManager           *m_groupManager;
 	QWeakPointer<TaskManager::TaskGroup> m_rootGroup; 
 	ToolTipBase                         *m_toolTip;
 
-	TaskbarLayout *m_layout;
+	TaskbarLayout      *m_layout;
+	CapacityController *m_capacityController;
+	RepaintScheduler   *m_repaintScheduler;
 	QHash<TaskManager::AbstractGroupableItem*, TaskItem*> m_tasksHash;
 	Ui::General    m_configG;
 	Ui::Appearance m_configA;
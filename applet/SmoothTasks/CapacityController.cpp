@@ -0,0 +1,108 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#include "SmoothTasks/CapacityController.h"
+#include "SmoothTasks/WakeupMonitor.h"
+
+#include <QTimer>
+
+namespace SmoothTasks {
+
+CapacityController::CapacityController(QObject *parent)
+		: QObject(parent),
+		  m_reevaluateTimer(new QTimer(this)),
+		  m_monotonicClock(),
+		  m_clock(&m_monotonicClock),
+		  m_lastFlip(0),
+		  m_limit(-1),
+		  m_full(false),
+		  m_fullCompression(0.0),
+		  m_ungroupMargin(0.1),
+		  m_minimumDwellTime(2000),
+		  m_flipCount(0),
+		  m_suppressedCount(0) {
+	m_reevaluateTimer->setSingleShot(true);
+
+	connect(m_reevaluateTimer, SIGNAL(timeout()), this, SIGNAL(reevaluate()));
+	WakeupMonitor::self()->watch(m_reevaluateTimer, "CapacityController");
+}
+
+void CapacityController::setClock(AnimationClock *clock) {
+	m_clock = clock ? clock : &m_monotonicClock;
+}
+
+void CapacityController::setUngroupMargin(qreal ungroupMargin) {
+	m_ungroupMargin = qMax(qreal(0.0), ungroupMargin);
+}
+
+void CapacityController::setMinimumDwellTime(int minimumDwellTime) {
+	m_minimumDwellTime = qMax(0, minimumDwellTime);
+}
+
+void CapacityController::reset() {
+	m_reevaluateTimer->stop();
+	m_limit = -1;
+	m_full  = false;
+}
+
+bool CapacityController::propose(int capacity, int itemCount, qreal compression) {
+	// like the group manager: it is full if there are as many items as the limit
+	const bool full = itemCount >= capacity;
+
+	if (m_limit == -1 || full == m_full) {
+		// no flip, the limit may follow freely
+		const bool changed = capacity != m_limit;
+
+		if (m_limit == -1) {
+			m_full = full;
+			m_fullCompression = compression;
+			m_lastFlip = m_clock->now();
+		}
+		m_reevaluateTimer->stop();
+		m_limit = capacity;
+
+		return changed;
+	}
+
+	// only ungroup if there is clearly more room than when grouping
+	if (!full && compression < m_fullCompression + m_ungroupMargin) {
+		++ m_suppressedCount;
+		return false;
+	}
+
+	const qint64 elapsed = m_clock->now() - m_lastFlip;
+
+	if (elapsed < m_minimumDwellTime) {
+		++ m_suppressedCount;
+		m_reevaluateTimer->start((int) (m_minimumDwellTime - elapsed));
+		return false;
+	}
+
+	m_reevaluateTimer->stop();
+	m_limit = capacity;
+	m_full  = full;
+	m_fullCompression = compression;
+	m_lastFlip = m_clock->now();
+	++ m_flipCount;
+
+	return true;
+}
+
+} // namespace SmoothTasks
+#include "CapacityController.moc"
@@ -0,0 +1,85 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_CAPACITYCONTROLLER_H
+#define SMOOTHTASKS_CAPACITYCONTROLLER_H
+
+#include "SmoothTasks/AnimationClock.h"
+
+#include <QObject>
+
+class QTimer;
+
+namespace SmoothTasks {
+
+// Decides which capacities proposed by the taskbar layout are passed on as the
+// full limit of the group manager. With "only group when full" every change
+// between full and not full regroups all tasks, which can change the
+// capacity again. To not flip back and forth the tasks are only ungrouped once
+// the layout's ungroupedCompression() is ungroupMargin() above the one they
+// were grouped at, and a flip is only taken once the last one is at least
+// minimumDwellTime() old.
+class CapacityController : public QObject {
+	Q_OBJECT
+
+public:
+	CapacityController(QObject *parent = NULL);
+
+	// Returns true if the limit changed and has to be passed on.
+	bool propose(int capacity, int itemCount, qreal compression);
+	void reset();
+
+	int  limit()  const { return m_limit; }
+	bool isFull() const { return m_full; }
+
+	qreal ungroupMargin() const { return m_ungroupMargin; }
+	void  setUngroupMargin(qreal ungroupMargin);
+
+	int  minimumDwellTime() const { return m_minimumDwellTime; }
+	void setMinimumDwellTime(int minimumDwellTime);
+
+	// flips between full and not full that were taken or suppressed
+	int flipCount()       const { return m_flipCount; }
+	int suppressedCount() const { return m_suppressedCount; }
+
+	// The clock the dwell time is measured with. It is not owned by the
+	// controller, pass NULL to go back to the monotonic clock.
+	AnimationClock *clock() const { return m_clock; }
+	void            setClock(AnimationClock *clock);
+
+signals:
+	// a suppressed flip might be taken now, the capacity should be proposed again
+	void reevaluate();
+
+private:
+	QTimer                  *m_reevaluateTimer;
+	MonotonicAnimationClock  m_monotonicClock;
+	AnimationClock          *m_clock;
+	qint64                   m_lastFlip;
+	int                      m_limit; // -1 until the first proposal
+	bool                     m_full;
+	qreal                    m_fullCompression; // when the tasks were grouped
+	qreal                    m_ungroupMargin;
+	int                      m_minimumDwellTime;
+	int                      m_flipCount;
+	int                      m_suppressedCount;
+};
+
+} // namespace SmoothTasks
+#endif
@@ -22,14 +22,13 @@
 #include "SmoothTasks/SmoothToolTip.h"
 #include "SmoothTasks/CloseIcon.h"
 
-#include <Plasma/PaintUtils>
-
 namespace SmoothTasks {
 
 CloseIcon::CloseIcon(WindowPreview *preview)
 	: QWidget(preview),
 	  m_preview(preview),
-	  m_highlite() {
+	  m_highlite(),
+	  m_fade() {
 	connect(
 		&m_highlite, SIGNAL(animate(qreal)),
 		this, SLOT(repaint()));
@@ -69,6 +68,7 @@ void CloseIcon::paintEvent(QPaintEvent *event) {
 	if (opacity > qreal(0.0)) {
 		QPainter painter(this);
 		QPixmap  pixmap;
+		QImage   image;
 		
 		if (m_highlite.atBottom()) {
 			pixmap = toolTip->closeIcon();
@@ -77,16 +77,22 @@ void CloseIcon::paintEvent(QPaintEvent *event) {
 			pixmap = toolTip->hoverCloseIcon();
 		}
 		else {
-			pixmap = Plasma::PaintUtils::transition(
-				toolTip->closeIcon(),
-				toolTip->hoverCloseIcon(),
-				m_highlite.value());
+			m_fade.addLayer(toolTip->closeIcon());
+			m_fade.addLayer(toolTip->hoverCloseIcon(), m_highlite.value());
+			image = m_fade.render();
 		}
 		
-		qreal x = qreal(width()  - pixmap.width())  * 0.5;
-		qreal y = qreal(height() - pixmap.height()) * 0.5;
+		const QSize size(pixmap.isNull() ? image.size() : pixmap.size());
+		qreal x = qreal(width()  - size.width())  * 0.5;
+		qreal y = qreal(height() - size.height()) * 0.5;
 		painter.setOpacity(opacity);
-		painter.drawPixmap(x, y, pixmap);
+
+		if (pixmap.isNull()) {
+			painter.drawImage(QPointF(x, y), image);
+		}
+		else {
+			painter.drawPixmap(x, y, pixmap);
+		}
 	}
 }
 
@@ -26,6 +26,7 @@
 #include "SmoothTasks/Applet.h"
 #include "SmoothTasks/WindowPreview.h"
 #include "SmoothTasks/ToggleAnimation.h"
+#include "SmoothTasks/CrossFade.h"
 
 namespace SmoothTasks {
 
@@ -39,6 +40,7 @@ public:
 private:
 	WindowPreview  *m_preview;
 	ToggleAnimation m_highlite;
+	CrossFade       m_fade;
 
 private slots:
 	void animate();
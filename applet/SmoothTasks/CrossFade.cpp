@@ -0,0 +1,258 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "SmoothTasks/CrossFade.h"
+#include "SmoothTasks/Global.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace SmoothTasks {
+
+namespace {
+
+// (a * (256 - w) + b * w + 128) / 256 for the two channels in the bytes 0
+// and 2. No lane exceeds 255 * 256 + 128, so they can't carry into each other.
+inline quint32 lerpChannels(quint32 a, quint32 b, quint32 w) {
+	return ((a * (256 - w) + b * w + 0x00800080) >> 8) & 0x00ff00ff;
+}
+
+inline quint32 lerpPixel(quint32 a, quint32 b, quint32 w) {
+	return
+		lerpChannels(a & 0x00ff00ff, b & 0x00ff00ff, w) |
+		(lerpChannels((a >> 8) & 0x00ff00ff, (b >> 8) & 0x00ff00ff, w) << 8);
+}
+
+} // namespace
+
+CrossFade::CrossFade()
+		: m_layerCount(0),
+		  m_buffer() {
+	for (int layer = 0; layer < MAX_LAYERS; ++ layer) {
+		m_pixmapKeys[layer] = 0;
+	}
+}
+
+void CrossFade::addLayer(const QImage& image, qreal amount) {
+	if (m_layerCount == MAX_LAYERS) {
+		qWarning("CrossFade::addLayer: more than %d layers", int(MAX_LAYERS));
+		return;
+	}
+
+	if (m_layerCount > 0 && image.size() != m_layers[0].size()) {
+		qWarning("CrossFade::addLayer: the layers differ in size");
+		return;
+	}
+
+	m_layers[m_layerCount] = image.format() == QImage::Format_ARGB32_Premultiplied ?
+		image : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+	m_weights[m_layerCount] = qBound(0, qRound(amount * 256), 256);
+	++ m_layerCount;
+}
+
+void CrossFade::addLayer(const QPixmap& pixmap, qreal amount) {
+	if (m_layerCount == MAX_LAYERS) {
+		addLayer(QImage(), amount);
+		return;
+	}
+
+	const qint64 key   = pixmap.cacheKey();
+	QImage&      image = m_pixmapImages[m_layerCount];
+
+	if (m_pixmapKeys[m_layerCount] != key) {
+		image = pixmapToImage(pixmap).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+		m_pixmapKeys[m_layerCount] = key;
+	}
+
+	addLayer(image, amount);
+}
+
+const QImage& CrossFade::render() {
+	if (m_layerCount == 0) {
+		m_buffer = QImage();
+		return m_buffer;
+	}
+
+	const QImage& base = m_layers[0];
+
+	if (m_buffer.size() != base.size()) {
+		m_buffer = QImage(base.size(), QImage::Format_ARGB32_Premultiplied);
+	}
+
+	const int width  = base.width();
+	const int height = base.height();
+	const quint32 *layers[MAX_LAYERS];
+
+	for (int y = 0; y < height; ++ y) {
+		for (int layer = 0; layer < m_layerCount; ++ layer) {
+			layers[layer] = reinterpret_cast<const quint32*>(m_layers[layer].constScanLine(y));
+		}
+
+		blend(reinterpret_cast<quint32*>(m_buffer.scanLine(y)), layers, m_weights, m_layerCount, width);
+	}
+
+	// don't keep the layers alive, their owners might want to paint on them
+	for (int layer = 0; layer < m_layerCount; ++ layer) {
+		m_layers[layer] = QImage();
+	}
+	m_layerCount = 0;
+
+	return m_buffer;
+}
+
+void CrossFade::blend(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length) {
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+	static const bool avx2 = hasAvx2();
+
+	if (avx2) {
+		blendAvx2(target, layers, weights, layerCount, length);
+		return;
+	}
+#endif
+#ifdef __SSE2__
+	blendSse2(target, layers, weights, layerCount, length);
+#else
+	blendScalar(target, layers, weights, layerCount, length);
+#endif
+}
+
+const char *CrossFade::kernelName() {
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+	if (hasAvx2()) {
+		return "AVX2";
+	}
+#endif
+#ifdef __SSE2__
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+bool CrossFade::hasAvx2() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+#endif
+
+void CrossFade::blendScalar(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length) {
+	for (int index = 0; index < length; ++ index) {
+		quint32 pixel = layers[0][index];
+
+		for (int layer = 1; layer < layerCount; ++ layer) {
+			pixel = lerpPixel(pixel, layers[layer][index], weights[layer]);
+		}
+
+		target[index] = pixel;
+	}
+}
+
+#ifdef __SSE2__
+// Four pixels at a time, the channels widened to 16 bits. The sums stay below
+// 65536, so unsigned 16 bit arithmetic is enough.
+void CrossFade::blendSse2(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length) {
+	const __m128i zero  = _mm_setzero_si128();
+	const __m128i full  = _mm_set1_epi16(256);
+	const __m128i round = _mm_set1_epi16(128);
+	const int     N     = length & ~3;
+
+	for (int index = 0; index < N; index += 4) {
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers[0] + index));
+		__m128i low    = _mm_unpacklo_epi8(pixels, zero);
+		__m128i high   = _mm_unpackhi_epi8(pixels, zero);
+
+		for (int layer = 1; layer < layerCount; ++ layer) {
+			const __m128i upper  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers[layer] + index));
+			const __m128i weight = _mm_set1_epi16(weights[layer]);
+			const __m128i rest   = _mm_sub_epi16(full, weight);
+
+			low = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(
+				_mm_mullo_epi16(low, rest),
+				_mm_mullo_epi16(_mm_unpacklo_epi8(upper, zero), weight)), round), 8);
+			high = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(
+				_mm_mullo_epi16(high, rest),
+				_mm_mullo_epi16(_mm_unpackhi_epi8(upper, zero), weight)), round), 8);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(target + index), _mm_packus_epi16(low, high));
+	}
+
+	if (N < length) {
+		const quint32 *tail[MAX_LAYERS];
+
+		for (int layer = 0; layer < layerCount; ++ layer) {
+			tail[layer] = layers[layer] + N;
+		}
+
+		blendScalar(target + N, tail, weights, layerCount, length - N);
+	}
+}
+#endif
+
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+// Like blendSse2() with eight pixels at a time. Unpacking and packing both
+// work within the 128 bit halves, so the pixels stay in order.
+__attribute__((target("avx2")))
+void CrossFade::blendAvx2(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length) {
+	const __m256i zero  = _mm256_setzero_si256();
+	const __m256i full  = _mm256_set1_epi16(256);
+	const __m256i round = _mm256_set1_epi16(128);
+	const int     N     = length & ~7;
+
+	for (int index = 0; index < N; index += 8) {
+		__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layers[0] + index));
+		__m256i low    = _mm256_unpacklo_epi8(pixels, zero);
+		__m256i high   = _mm256_unpackhi_epi8(pixels, zero);
+
+		for (int layer = 1; layer < layerCount; ++ layer) {
+			const __m256i upper  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layers[layer] + index));
+			const __m256i weight = _mm256_set1_epi16(weights[layer]);
+			const __m256i rest   = _mm256_sub_epi16(full, weight);
+
+			low = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(
+				_mm256_mullo_epi16(low, rest),
+				_mm256_mullo_epi16(_mm256_unpacklo_epi8(upper, zero), weight)), round), 8);
+			high = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(
+				_mm256_mullo_epi16(high, rest),
+				_mm256_mullo_epi16(_mm256_unpackhi_epi8(upper, zero), weight)), round), 8);
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + index), _mm256_packus_epi16(low, high));
+	}
+
+	if (N < length) {
+		const quint32 *tail[MAX_LAYERS];
+
+		for (int layer = 0; layer < layerCount; ++ layer) {
+			tail[layer] = layers[layer] + N;
+		}
+
+		blendSse2(target + N, tail, weights, layerCount, length - N);
+	}
+}
+#endif
+
+} // namespace SmoothTasks
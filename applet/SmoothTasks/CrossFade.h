@@ -0,0 +1,96 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_CROSSFADE_H
+#define SMOOTHTASKS_CROSSFADE_H
+
+#include <QImage>
+#include <QPixmap>
+
+// The AVX2 kernel is built with the GNU compilers on x86-64 whatever the
+// target of the build is, and only used if the processor has AVX2.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SMOOTHTASKS_CROSSFADE_AVX2
+#endif
+
+namespace SmoothTasks {
+
+// Cross-fades layers of premultiplied ARGB32 images in one pass, like a chain
+// of Plasma::PaintUtils::transition() calls but without a new pixmap per
+// step. The first layer is the bottom, every further layer is faded in over
+// what is below it by its amount:
+//
+//   CrossFade fade;
+//   fade.addLayer(normal);
+//   fade.addLayer(hover, 0.3);
+//   painter.drawImage(pos, fade.render());
+//
+// The result is kept in a buffer that is reused by the next render() of the
+// same size, so a CrossFade should live as long as the thing it animates.
+class CrossFade {
+
+public:
+	enum { MAX_LAYERS = 8 };
+
+	CrossFade();
+
+	// The amount of the first layer is ignored. All layers need the size of
+	// the first one.
+	void addLayer(const QImage& image, qreal amount = 1.0);
+
+	// Like above, but the image the pixmap was converted to is kept for the
+	// next render(). As long as the same pixmap is given for a layer it is
+	// not fetched from the X server again.
+	void addLayer(const QPixmap& pixmap, qreal amount = 1.0);
+	int  layerCount() const { return m_layerCount; }
+
+	// Blends the layers into the buffer and forgets them. Returns a null
+	// image if there were no layers.
+	const QImage& render();
+
+	// The kernels: blend length pixels of layerCount layers into target,
+	// the weights of the layers above the first one are in 0..256.
+	// blend() uses the fastest kernel the build and the processor support.
+	static void blend(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length);
+	static void blendScalar(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length);
+#ifdef __SSE2__
+	static void blendSse2(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length);
+#endif
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+	// only call it if hasAvx2() is true
+	static void blendAvx2(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length);
+	static bool hasAvx2();
+#endif
+
+	// name of the kernel used by blend()
+	static const char *kernelName();
+
+private:
+	QImage m_layers[MAX_LAYERS];
+	int    m_weights[MAX_LAYERS];
+	int    m_layerCount;
+	QImage m_buffer;
+
+	// the images of the pixmap layers by QPixmap::cacheKey()
+	QImage m_pixmapImages[MAX_LAYERS];
+	qint64 m_pixmapKeys[MAX_LAYERS];
+};
+
+} // namespace SmoothTasks
+#endif
@@ -19,6 +19,7 @@
 ***********************************************************************************/
 #include "SmoothTasks/DelayedToolTip.h"
 #include "SmoothTasks/Applet.h"
+#include "SmoothTasks/WakeupMonitor.h"
 
 namespace SmoothTasks {
 
@@ -32,6 +33,7 @@ DelayedToolTip::DelayedToolTip(Applet *applet)
 	connect(
 		m_delayTimer, SIGNAL(timeout()),
 		this, SLOT(timeout()));
+	WakeupMonitor::self()->watch(m_delayTimer, "DelayedToolTip");
 }
 	
 void DelayedToolTip::quickShow(TaskItem *item) {
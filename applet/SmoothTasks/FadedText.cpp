@@ -22,13 +22,13 @@
 #include <QSizePolicy>
 #include <QPainter>
 
-#include <Plasma/PaintUtils>
-#include <Plasma/Animator>
-
 #include <cmath>
 
 #include "SmoothTasks/FadedText.h"
+#include "SmoothTasks/AnimationDriver.h"
+#include "SmoothTasks/WakeupMonitor.h"
 #include "SmoothTasks/Global.h"
+#include "SmoothTasks/ShadowBlur.h"
 
 namespace SmoothTasks {
 
@@ -52,16 +52,12 @@ void FadedText::init() {
 	m_textOption.setWrapMode(QTextOption::NoWrap);
 	setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Minimum);
 	
-	connect(
-		Plasma::Animator::self(), SIGNAL(customAnimationFinished(int)),
-		this, SLOT(animationFinished(int)));
-	
 	updateText();
 }
 
 FadedText::~FadedText() {
 	if (m_scrollAnimation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_scrollAnimation);
+		AnimationDriver::self()->stop(m_scrollAnimation);
 		m_scrollAnimation = 0;
 		m_scrollState     = NoScroll;
 	}
@@ -95,10 +91,11 @@ QPointF FadedText::visualPos(Qt::LayoutDirection direction, const QRect& boundin
 
 void FadedText::drawTextLayout(QPainter& painter, const QTextLayout& layout, const QSizeF& textSize) {
 	const bool rtl = layout.textOption().textDirection() == Qt::RightToLeft;
-	QPixmap pixmap(size());
-	pixmap.fill(Qt::transparent);
+	// rendered on the client side, so the shadow doesn't have to fetch it
+	QImage image(size(), QImage::Format_ARGB32_Premultiplied);
+	image.fill(0);
 	
-	QPainter p(&pixmap);
+	QPainter p(&image);
 	p.setPen(painter.pen());
 
 	// Create the alpha gradient for the fade out effect
@@ -139,7 +136,7 @@ void FadedText::drawTextLayout(QPainter& painter, const QTextLayout& layout, con
 		if (lineRight > width()) {
 			int dist = lineRight - width();
 			int fadeWidth = dist < m_fadeWidth ? dist : m_fadeWidth;
-			int x = pixmap.width() - fadeWidth;
+			int x = image.width() - fadeWidth;
 			fadeEndRects.append(QRect(x, y, fadeWidth, int(line.height())));
 		}
 		if (lineLeft < 0) {
@@ -173,12 +170,12 @@ void FadedText::drawTextLayout(QPainter& painter, const QTextLayout& layout, con
 	}
 	
 	if (m_shadow) {
-		QImage shadow(pixmap.toImage());
-		Plasma::PaintUtils::shadowBlur(shadow, 2, shadowColor);
+		QImage shadow(image);
+		ShadowBlur::apply(shadow, 2, shadowColor);
 		painter.drawImage(1, 2, shadow);
 	}
 	
-	painter.drawPixmap(0, 0, pixmap);
+	painter.drawImage(0, 0, image);
 }
 
 void FadedText::setText(const QString& text) {
@@ -205,7 +202,7 @@ void FadedText::mousePressEvent(QMouseEvent *event) {
 	if (m_sizeHint.width() > width()) {
 		stopTimer();
 		if (m_scrollAnimation) {
-			Plasma::Animator::self()->stopCustomAnimation(m_scrollAnimation);
+			AnimationDriver::self()->stop(m_scrollAnimation);
 			m_scrollAnimation = 0;
 			m_scrollState     = WaitLeftScroll;
 		}
@@ -322,7 +319,7 @@ void FadedText::updateText() {
 void FadedText::startScrollAnimation() {
 	if (m_sizeHint.width() > width()) {
 		if (m_scrollAnimation) {
-			Plasma::Animator::self()->stopCustomAnimation(m_scrollAnimation);
+			AnimationDriver::self()->stop(m_scrollAnimation);
 		}
 
 		switch (m_scrollState) {
@@ -352,7 +349,7 @@ void FadedText::stopScrollAnimation() {
 	const bool rtl = m_textOption.textDirection() == Qt::RightToLeft;
 
 	if (m_scrollAnimation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_scrollAnimation);
+		AnimationDriver::self()->stop(m_scrollAnimation);
 	}
 
 	if (rtl) {
@@ -399,10 +396,8 @@ void FadedText::startScrollAnimation(ScrollState scrollState, int offset, int di
 		animationFinished(m_scrollAnimation);
 	}
 	else {
-		m_scrollAnimation = Plasma::Animator::self()->customAnimation(
-			frames, duration,
-			Plasma::Animator::LinearCurve,
-			this, "animateScroll");
+		m_scrollAnimation = AnimationDriver::self()->start(
+			duration, m_fps, this, "animateScroll", "animationFinished");
 	}
 }
 
@@ -465,6 +460,7 @@ void FadedText::singleShot(int ms, const char *slot) {
 	else {
 		m_delayTimer = new QTimer(this);
 		m_delayTimer->setSingleShot(true);
+		WakeupMonitor::self()->watch(m_delayTimer, "FadedText");
 	}
 
 	connect(m_delayTimer, SIGNAL(timeout()), this, slot);
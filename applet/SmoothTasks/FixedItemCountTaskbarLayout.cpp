@@ -38,12 +38,9 @@ int FixedItemCountTaskbarLayout::optimumCapacity() const {
 }
 
 void FixedItemCountTaskbarLayout::doLayout() {
-	// I think this way the loops can be optimized by the compiler.
-	// (lifting out the comparison and making two loops; TODO: find out whether this is true):
 	const bool isVertical = orientation() == Qt::Vertical;
 
-	const QList<TaskbarItem*>& items = this->items();
-	const int N = items.size();
+	const int N = count();
 
 	// if there is nothing to layout fill in some dummy data and leave
 	if (N == 0) {
@@ -61,10 +58,7 @@ void FixedItemCountTaskbarLayout::doLayout() {
 
 		QSizeF newPreferredSize(qMin(10.0, rect.width()), qMin(10.0, rect.height()));
 
-		if (newPreferredSize != m_preferredSize) {
-			m_preferredSize = newPreferredSize;
-			emit sizeHintChanged(Qt::PreferredSize);
-		}
+		setPreferredSize(newPreferredSize);
 
 		return;
 	}
@@ -89,13 +83,12 @@ void FixedItemCountTaskbarLayout::doLayout() {
 	qreal cellHeight = CELL_HEIGHT(rows);
 	qreal cellWidth  = cellHeight * aspectRatio();
 
-	QList<RowInfo> rowInfos;
 	qreal maxPreferredRowWidth = 0;
 
-	buildRows(itemsPerRow, cellWidth, rowInfos, rows, maxPreferredRowWidth);
+	buildRows(itemsPerRow, cellWidth, rows, maxPreferredRowWidth);
 	cellHeight = CELL_HEIGHT(rows);
 
-	updateLayout(rows, cellWidth, cellHeight, availableWidth, maxPreferredRowWidth, rowInfos, effectiveRect);
+	updateLayout(rows, cellWidth, cellHeight, availableWidth, maxPreferredRowWidth, effectiveRect);
 
 #undef CELL_HEIGHT
 }
@@ -96,12 +96,9 @@ int FixedSizeTaskbarLayout::rowOf(const QPointF& pos) const {
 }
 
 void FixedSizeTaskbarLayout::doLayout() {
-	// I think this way the loops can be optimized by the compiler.
-	// (lifting out the comparison and making two loops; TODO: find out whether this is true):
 	const bool isVertical = orientation() == Qt::Vertical;
 
-	const QList<TaskbarItem*>& items = this->items();
-	const int N = items.size();
+	const int N = count();
 
 	qreal left = 0, top = 0, right = 0, bottom = 0;
 	getContentsMargins(&left, &top, &right, &bottom);
@@ -124,10 +121,7 @@ void FixedSizeTaskbarLayout::doLayout() {
 			newPreferredSize.setHeight(top + m_fixedCellHeight + bottom);
 		}
 
-		if (newPreferredSize != m_preferredSize) {
-			m_preferredSize = newPreferredSize;
-			emit sizeHintChanged(Qt::PreferredSize);
-		}
+		setPreferredSize(newPreferredSize);
 
 		return;
 	}
@@ -154,13 +148,12 @@ void FixedSizeTaskbarLayout::doLayout() {
 		itemsPerRow = std::ceil(((qreal) N) / rows);
 	}
 
-	QList<RowInfo> rowInfos;
 	qreal maxPreferredRowWidth = 0;
 
-	buildRows(itemsPerRow, cellWidth, rowInfos, rows, maxPreferredRowWidth);
+	buildRows(itemsPerRow, cellWidth, rows, maxPreferredRowWidth);
 	qreal cellHeight = qMin(m_fixedCellHeight, CELL_HEIGHT(rows));
 
-	updateLayout(rows, cellWidth, cellHeight, availableWidth, maxPreferredRowWidth, rowInfos, effectiveRect);
+	updateLayout(rows, cellWidth, cellHeight, availableWidth, maxPreferredRowWidth, effectiveRect);
 
 #undef CELL_HEIGHT
 }
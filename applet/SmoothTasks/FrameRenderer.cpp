@@ -0,0 +1,278 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Smooth Tasks
+#include "SmoothTasks/FrameRenderer.h"
+
+// Qt
+#include <QPainter>
+#include <QTransform>
+
+// Plasma
+#include <Plasma/FrameSvg>
+
+namespace SmoothTasks {
+
+namespace {
+
+const char * const SLICE_NAMES[] = {
+	"topleft",    "top",    "topright",
+	"left",       "center", "right",
+	"bottomleft", "bottom", "bottomright"
+};
+
+// the slice of the horizontal frame that ends up at each slice of the
+// vertical one when it is turned counter clockwise
+const int VERTICAL_SLICES[] = {
+	2, 5, 8,
+	1, 4, 7,
+	0, 3, 6
+};
+
+// in kilobytes, enough for the frames of all states of a few item sizes
+const int MAX_IMAGE_COST = 2048;
+
+} // namespace
+
+bool FrameRenderer::ImageKey::operator == (const ImageKey& other) const {
+	return
+		size        == other.size &&
+		orientation == other.orientation &&
+		prefix      == other.prefix;
+}
+
+uint qHash(const FrameRenderer::ImageKey& key) {
+	return qHash(key.prefix) ^ (uint(key.size.width()) << 16) ^
+		uint(key.size.height()) ^ (key.orientation == Qt::Vertical ? 0x80000000 : 0);
+}
+
+FrameRenderer::FrameRenderer(Plasma::FrameSvg *frame, QObject *parent)
+		: QObject(parent),
+		  m_frame(frame),
+		  m_slices(),
+		  m_verticalSlices(),
+		  m_images(MAX_IMAGE_COST),
+		  m_renderCount(0) {
+	connect(m_frame, SIGNAL(repaintNeeded()), this, SLOT(invalidate()));
+}
+
+void FrameRenderer::invalidate() {
+	m_slices.clear();
+	m_verticalSlices.clear();
+	m_images.clear();
+}
+
+FrameRenderer::Slices& FrameRenderer::slices(const QString& prefix, Qt::Orientation orientation) {
+	QHash<QString, Slices>::iterator it = m_slices.find(prefix);
+
+	if (it == m_slices.end()) {
+		it = m_slices.insert(prefix, Slices());
+		render(prefix, *it);
+	}
+
+	if (orientation == Qt::Horizontal) {
+		return *it;
+	}
+
+	QHash<QString, Slices>::iterator vertical = m_verticalSlices.find(prefix);
+
+	if (vertical == m_verticalSlices.end()) {
+		vertical = m_verticalSlices.insert(prefix, Slices());
+		rotate(*it, *vertical);
+	}
+
+	return *vertical;
+}
+
+void FrameRenderer::render(const QString& prefix, Slices& slices) {
+	// like FrameSvg::setElementPrefix() fall back to the unprefixed frame
+	const QString elementPrefix(
+		!prefix.isEmpty() && m_frame->hasElement(prefix + "-center") ?
+		prefix + '-' : QString());
+
+	// the slices in the size the theme made them
+	m_frame->resize();
+
+	for (int slice = 0; slice < SLICE_COUNT; ++ slice) {
+		const QString element(elementPrefix + QLatin1String(SLICE_NAMES[slice]));
+		const QSize   size(m_frame->elementSize(element));
+		QPixmap&      pixmap = slices.pixmaps[slice];
+
+		if (size.isEmpty()) {
+			pixmap = QPixmap();
+			continue;
+		}
+
+		pixmap = QPixmap(size);
+		pixmap.fill(Qt::transparent);
+
+		QPainter painter(&pixmap);
+		m_frame->paint(&painter, QRectF(QPointF(0, 0), size), element);
+	}
+
+	slices.leftWidth    = slices.pixmaps[Left].width();
+	slices.topHeight    = slices.pixmaps[Top].height();
+	slices.rightWidth   = slices.pixmaps[Right].width();
+	slices.bottomHeight = slices.pixmaps[Bottom].height();
+
+	slices.stretchBorders =
+		m_frame->hasElement("hint-stretch-borders") ||
+		m_frame->hasElement(elementPrefix + "hint-stretch-borders");
+	slices.tileCenter =
+		m_frame->hasElement("hint-tile-center") ||
+		m_frame->hasElement(elementPrefix + "hint-tile-center");
+
+	// the margins can differ from the slices by hints of the theme
+	m_frame->setElementPrefix(prefix);
+	m_frame->getMargins(slices.leftMargin, slices.topMargin, slices.rightMargin, slices.bottomMargin);
+
+	++ m_renderCount;
+}
+
+void FrameRenderer::rotate(const Slices& slices, Slices& rotated) {
+	QTransform transform;
+	transform.rotate(-90);
+
+	for (int slice = 0; slice < SLICE_COUNT; ++ slice) {
+		const QPixmap& pixmap = slices.pixmaps[VERTICAL_SLICES[slice]];
+
+		rotated.pixmaps[slice] = pixmap.isNull() ? QPixmap() : pixmap.transformed(transform);
+	}
+
+	rotated.leftWidth      = slices.topHeight;
+	rotated.topHeight      = slices.rightWidth;
+	rotated.rightWidth     = slices.bottomHeight;
+	rotated.bottomHeight   = slices.leftWidth;
+	rotated.leftMargin     = slices.topMargin;
+	rotated.topMargin      = slices.rightMargin;
+	rotated.rightMargin    = slices.bottomMargin;
+	rotated.bottomMargin   = slices.leftMargin;
+	rotated.stretchBorders = slices.stretchBorders;
+	rotated.tileCenter     = slices.tileCenter;
+}
+
+void FrameRenderer::compose(QPainter *painter, const Slices& slices, const QRectF& rect) {
+	const qreal width  = rect.width();
+	const qreal height = rect.height();
+	qreal left   = slices.leftWidth;
+	qreal top    = slices.topHeight;
+	qreal right  = slices.rightWidth;
+	qreal bottom = slices.bottomHeight;
+
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	// frames smaller than their borders get smaller borders
+	bool shrunk = false;
+
+	if (left + right > width) {
+		left   = width * left / (left + right);
+		right  = width - left;
+		shrunk = true;
+	}
+
+	if (top + bottom > height) {
+		top    = height * top / (top + bottom);
+		bottom = height - top;
+		shrunk = true;
+	}
+
+	const qreal x[] = { rect.left(), rect.left() + left, rect.right() - right };
+	const qreal y[] = { rect.top(),  rect.top()  + top,  rect.bottom() - bottom };
+	const qreal w[] = { left, width  - left - right, right };
+	const qreal h[] = { top,  height - top  - bottom, bottom };
+
+	const bool smooth = painter->testRenderHint(QPainter::SmoothPixmapTransform);
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+	for (int row = 0; row < 3; ++ row) {
+		for (int column = 0; column < 3; ++ column) {
+			const QPixmap& pixmap = slices.pixmaps[row * 3 + column];
+			const QRectF   target(x[column], y[row], w[column], h[row]);
+
+			if (pixmap.isNull() || target.isEmpty()) {
+				continue;
+			}
+
+			const bool isCorner = row != 1 && column != 1;
+			const bool isCenter = row == 1 && column == 1;
+			const bool tile     = !shrunk && !isCorner &&
+				(isCenter ? slices.tileCenter : !slices.stretchBorders);
+
+			if (tile) {
+				painter->drawTiledPixmap(target, pixmap);
+			}
+			else {
+				painter->drawPixmap(target, pixmap, QRectF(pixmap.rect()));
+			}
+		}
+	}
+
+	painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+}
+
+void FrameRenderer::paintFrame(QPainter *painter, const QString& prefix, const QRectF& rect, Qt::Orientation orientation) {
+	compose(painter, slices(prefix, orientation), QRectF(rect.topLeft(), rect.size().toSize()));
+}
+
+QImage FrameRenderer::frameImage(const QString& prefix, const QSize& size, Qt::Orientation orientation) {
+	ImageKey key;
+	key.prefix      = prefix;
+	key.size        = size;
+	key.orientation = orientation;
+
+	const QImage *cached = m_images.object(key);
+
+	if (cached) {
+		return *cached;
+	}
+
+	QImage image(size, QImage::Format_ARGB32_Premultiplied);
+	image.fill(0);
+
+	QPainter painter(&image);
+	compose(&painter, slices(prefix, orientation), QRectF(QPointF(0, 0), size));
+	painter.end();
+
+	// images are shared, so the copy is cheap
+	m_images.insert(key, new QImage(image), qMax(1, image.byteCount() / 1024));
+
+	return image;
+}
+
+void FrameRenderer::getMargins(const QString& prefix, qreal& left, qreal& top, qreal& right, qreal& bottom, Qt::Orientation orientation) {
+	const Slices& frame = slices(prefix, orientation);
+
+	left   = frame.leftMargin;
+	top    = frame.topMargin;
+	right  = frame.rightMargin;
+	bottom = frame.bottomMargin;
+}
+
+QRectF FrameRenderer::contentsRect(const QString& prefix, const QSizeF& size, Qt::Orientation orientation) {
+	const Slices& frame = slices(prefix, orientation);
+	const QRectF  rect(QPointF(0, 0), size.toSize());
+
+	return rect.adjusted(frame.leftMargin, frame.topMargin, -frame.rightMargin, -frame.bottomMargin);
+}
+
+} // namespace SmoothTasks
+#include "FrameRenderer.moc"
@@ -0,0 +1,122 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_FRAMERENDERER_H
+#define SMOOTHTASKS_FRAMERENDERER_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QRectF>
+#include <QString>
+
+class QPainter;
+
+namespace Plasma {
+	class FrameSvg;
+}
+
+namespace SmoothTasks {
+
+// Paints the frames of a FrameSvg in any size from nine slices: the corners,
+// the edges and the center of every prefix are rasterized once per theme and
+// then blitted, so frames that change their size every animation frame don't
+// render the SVG again. The FrameSvg is not owned, and the renderer starts
+// over when it needs a repaint because the theme changed.
+//
+// Like FrameSvg the edges are tiled unless the theme has the element
+// "hint-stretch-borders" and the center is stretched unless it has
+// "hint-tile-center". Other hints are not supported.
+//
+// Vertical frames are the horizontal ones turned by 90 degrees counter
+// clockwise. They are composed from slices that are turned once, so the
+// painter does not have to rotate every blit. Their margins are turned, too.
+class FrameRenderer : public QObject {
+	Q_OBJECT
+
+public:
+	FrameRenderer(Plasma::FrameSvg *frame, QObject *parent = NULL);
+
+	void    paintFrame(QPainter *painter, const QString& prefix, const QRectF& rect,
+		Qt::Orientation orientation = Qt::Horizontal);
+
+	// The frame as premultiplied ARGB32 image. The images of the sizes used
+	// last are kept, so items of different sizes don't evict each other.
+	QImage  frameImage(const QString& prefix, const QSize& size,
+		Qt::Orientation orientation = Qt::Horizontal);
+
+	void    getMargins(const QString& prefix, qreal& left, qreal& top, qreal& right, qreal& bottom,
+		Qt::Orientation orientation = Qt::Horizontal);
+	QRectF  contentsRect(const QString& prefix, const QSizeF& size,
+		Qt::Orientation orientation = Qt::Horizontal);
+
+	// how often prefixes were rasterized
+	int     renderCount() const { return m_renderCount; }
+
+public slots:
+	void invalidate();
+
+private:
+	enum Slice {
+		TopLeft, Top, TopRight,
+		Left, Center, Right,
+		BottomLeft, Bottom, BottomRight,
+		SLICE_COUNT
+	};
+
+	struct Slices {
+		QPixmap pixmaps[SLICE_COUNT];
+		int     leftWidth;
+		int     topHeight;
+		int     rightWidth;
+		int     bottomHeight;
+		qreal   leftMargin;
+		qreal   topMargin;
+		qreal   rightMargin;
+		qreal   bottomMargin;
+		bool    stretchBorders;
+		bool    tileCenter;
+	};
+
+	struct ImageKey {
+		QString         prefix;
+		QSize           size;
+		Qt::Orientation orientation;
+
+		bool operator == (const ImageKey& other) const;
+	};
+
+	friend uint qHash(const ImageKey& key);
+
+	Slices&       slices(const QString& prefix, Qt::Orientation orientation = Qt::Horizontal);
+	void          render(const QString& prefix, Slices& slices);
+	static void   rotate(const Slices& slices, Slices& rotated);
+	static void   compose(QPainter *painter, const Slices& slices, const QRectF& rect);
+
+	Plasma::FrameSvg         *m_frame;
+	QHash<QString, Slices>    m_slices;
+	QHash<QString, Slices>    m_verticalSlices;
+	QCache<ImageKey, QImage>  m_images;
+	int                       m_renderCount;
+};
+
+} // namespace SmoothTasks
+#endif
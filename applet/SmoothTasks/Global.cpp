@@ -37,6 +37,13 @@ const QString HOVER            = QString::fromLatin1("hover");
 const QString M                = QString::fromLatin1("M");
 const int     DRAG_HOVER_DELAY = 500;
 
+namespace {
+
+int pixmapToImageConversions = 0;
+int imageToPixmapConversions = 0;
+
+} // namespace
+
 QSizeF layoutText(QTextLayout &layout, const QSizeF &constraints) {
 	QFontMetrics metrics(layout.font());
 	const qreal maxWidth  = constraints.width();
@@ -78,4 +85,22 @@ QSizeF layoutText(QTextLayout &layout, const QSizeF &constraints) {
 	return QSizeF(widthUsed, height);
 }
 
+QImage pixmapToImage(const QPixmap& pixmap) {
+	++ pixmapToImageConversions;
+	return pixmap.toImage();
+}
+
+QPixmap imageToPixmap(const QImage& image) {
+	++ imageToPixmapConversions;
+	return QPixmap::fromImage(image);
+}
+
+int pixmapToImageCount() {
+	return pixmapToImageConversions;
+}
+
+int imageToPixmapCount() {
+	return imageToPixmapConversions;
+}
+
 } // namespace SmoothTasks
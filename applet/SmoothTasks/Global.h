@@ -20,6 +20,8 @@
 #ifndef SMOOTHTASKS_GLOBAL_H
 #define SMOOTHTASKS_GLOBAL_H
 
+#include <QImage>
+#include <QPixmap>
 #include <QSizeF>
 #include <QTextLayout>
 
@@ -36,6 +38,15 @@ namespace SmoothTasks {
 	extern const int     DRAG_HOVER_DELAY;
 
 	QSizeF layoutText(QTextLayout &layout, const QSizeF &constraints);
+
+	// Conversions between images and pixmaps. Pixmaps live in the X server,
+	// so every conversion to an image is a round trip and every conversion
+	// to a pixmap an upload. Use these instead of QPixmap::toImage() and
+	// QPixmap::fromImage(), so they are counted.
+	QImage  pixmapToImage(const QPixmap& pixmap);
+	QPixmap imageToPixmap(const QImage& image);
+	int     pixmapToImageCount();
+	int     imageToPixmapCount();
 }
 
 #endif
@@ -0,0 +1,114 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Smooth Tasks
+#include "SmoothTasks/LabelCache.h"
+
+// Qt
+#include <QPainter>
+
+namespace SmoothTasks {
+
+namespace {
+
+// in kilobytes, enough for the labels of a few crowded taskbars
+const int MAX_COST = 4096;
+
+int cost(const LabelCache::Label& label) {
+	const int bytes =
+		label.pixmap.width() * label.pixmap.height() * 4 +
+		label.shadow.width() * label.shadow.height() * 4;
+	return qMax(1, bytes / 1024);
+}
+
+} // namespace
+
+LabelCache::Key::Key()
+		: text(),
+		  font(),
+		  size(),
+		  color(0),
+		  shadow(false),
+		  direction(Qt::LeftToRight),
+		  groupCount(0),
+		  expander() {
+}
+
+bool LabelCache::Key::operator == (const Key& other) const {
+	return
+		color      == other.color &&
+		size       == other.size &&
+		groupCount == other.groupCount &&
+		shadow     == other.shadow &&
+		direction  == other.direction &&
+		text       == other.text &&
+		font       == other.font &&
+		expander   == other.expander;
+}
+
+uint qHash(const LabelCache::Key& key) {
+	return qHash(key.text) ^ (qHash(key.font) << 1) ^ key.color ^
+		(uint(key.size.width()) << 16) ^ uint(key.size.height()) ^
+		(uint(key.groupCount) << 8) ^ (key.shadow ? 0x80000000 : 0) ^
+		(key.direction == Qt::RightToLeft ? 0x40000000 : 0);
+}
+
+void LabelCache::Label::paint(QPainter *painter, const QPointF& origin) const {
+	if (!shadow.isNull()) {
+		painter->drawPixmap(origin + position + QPointF(1, 2), shadow);
+	}
+
+	if (!pixmap.isNull()) {
+		painter->drawPixmap(origin + position, pixmap);
+	}
+}
+
+LabelCache::LabelCache(QObject *parent)
+		: QObject(parent),
+		  m_labels(MAX_COST),
+		  m_hits(0),
+		  m_misses(0) {
+}
+
+const LabelCache::Label *LabelCache::find(const Key& key) {
+	const Label *label = m_labels.object(key);
+
+	if (label) {
+		++ m_hits;
+	}
+	else {
+		++ m_misses;
+	}
+
+	return label;
+}
+
+void LabelCache::insert(const Key& key, const Label& label) {
+	// pixmaps and images are shared, so the copy is cheap
+	m_labels.insert(key, new Label(label), cost(label));
+}
+
+void LabelCache::clear() {
+	m_labels.clear();
+}
+
+} // namespace SmoothTasks
+
+#include "LabelCache.moc"
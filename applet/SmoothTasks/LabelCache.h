@@ -0,0 +1,90 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_LABELCACHE_H
+#define SMOOTHTASKS_LABELCACHE_H
+
+#include <QCache>
+#include <QColor>
+#include <QObject>
+#include <QPixmap>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+
+class QPainter;
+
+namespace SmoothTasks {
+
+// Keeps the finished labels of the task items, so repaints for a hover or a
+// moving light blit them instead of laying out, rasterizing and blurring the
+// text again. A label is found by everything it was rendered from, so a label
+// that changed in any way is a miss and rendered anew. Labels that weren't used
+// for a while are dropped once the cache is full.
+class LabelCache : public QObject {
+	Q_OBJECT
+
+public:
+	struct Key {
+		Key();
+
+		QString             text;
+		QString             font;       // QFont::key()
+		QSize               size;       // of the text rect
+		QRgb                color;
+		bool                shadow;
+		Qt::LayoutDirection direction;
+		int                 groupCount; // 0 for tasks
+		QString             expander;   // the SVG element of the group expander
+
+		bool operator == (const Key& other) const;
+	};
+
+	struct Label {
+		QPixmap pixmap;
+		QPixmap shadow;   // null without a text shadow
+		QPointF position; // of the pixmap relative to the text rect
+
+		void paint(QPainter *painter, const QPointF& origin) const;
+	};
+
+	LabelCache(QObject *parent = NULL);
+
+	// Returns NULL if there is no such label. The label stays valid until
+	// the next insert() or clear().
+	const Label *find(const Key& key);
+	void         insert(const Key& key, const Label& label);
+
+	int count()  const { return m_labels.count(); }
+	int hits()   const { return m_hits; }
+	int misses() const { return m_misses; }
+
+public slots:
+	void clear();
+
+private:
+	QCache<Key, Label> m_labels;
+	int                m_hits;
+	int                m_misses;
+};
+
+uint qHash(const LabelCache::Key& key);
+
+} // namespace SmoothTasks
+#endif
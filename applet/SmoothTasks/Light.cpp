@@ -21,50 +21,23 @@
 
 // Smooth Tasks
 #include "SmoothTasks/Light.h"
-#include "SmoothTasks/Applet.h"
-#include "SmoothTasks/TaskItem.h"
-#include "SmoothTasks/TaskIcon.h"
+#include "SmoothTasks/PulseAnimation.h"
 
 // Qt
-#include <QTimer>
 #include <QPainter>
-#include <QStyleOptionGraphicsItem>
-
-// Plasma
-#include <Plasma/Applet>
-#include <Plasma/PaintUtils>
-
-// KDE
-#include <KIcon>
-#include <KIconEffect>
-#include <KIconLoader>
-
-// Other
-#include <cmath>
+#include <QRadialGradient>
 
 namespace SmoothTasks {
 
-Light::Light(TaskItem *item) : QObject(item),
-	m_item(item),
-	m_count(0),
-	m_currentAnimationDuration(0),
-	m_animation(0),
-	m_progress(0.0),
+Light::Light(QObject *parent) : QObject(parent),
+	m_animation(new PulseAnimation(this)),
 	m_move(true),
-	m_currentAnimation(NoAnimation),
-	m_animationRepeater(new QTimer()),
-	m_repeater(true) {
-}
-
-Light::~Light() {
-	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
-	}
-	m_animationRepeater->deleteLater();
+	m_currentAnimation(NoAnimation) {
+	connect(m_animation, SIGNAL(update()), this, SIGNAL(update()));
 }
 
-void Light::paint(QPainter *p, const QRectF& boundingRect, const QPointF& mousePos, bool mouseIn, const bool isRotated) {
-	if (!mouseIn && !m_animation) {
+void Light::paint(QPainter *p, const QRectF& boundingRect, const QPointF& mousePos, bool mouseIn, const QColor& color) {
+	if (!mouseIn && !m_animation->isActive()) {
 		return;
 	}
 
@@ -78,7 +51,8 @@ void Light::paint(QPainter *p, const QRectF& boundingRect, const QPointF& mouseP
 	qreal  size   = 0.5;
 	qreal  x;
 	qreal  y;
-	QColor lightColor(m_item->icon()->highlightColor());
+	qreal  progress = m_animation->progress();
+	QColor lightColor(color);
 
 	switch (m_currentAnimation) {
 	case StartupAnimation:
@@ -86,17 +60,11 @@ void Light::paint(QPainter *p, const QRectF& boundingRect, const QPointF& mouseP
 		x = drawRect.left() + width  * 0.5;
 		y = drawRect.top()  + height * 0.5;
 		size = size * 2.0 *
-			(m_progress < 0.5 ? (m_progress * 0.5 + 0.5) : (1 - m_progress / 2));
+			(progress < 0.5 ? (progress * 0.5 + 0.5) : (1 - progress / 2));
 		break;
 	case NoAnimation:
-		if (isRotated) {
-			x = m_item->size().height() - mousePos.y();
-			y = mousePos.x();
-		}
-		else {
-			x = mousePos.x();
-			y = mousePos.y();
-		}
+		x = mousePos.x();
+		y = mousePos.y();
 		// y = drawRect.top() + height * 1.10;
 		width  *= 2.0;
 		height *= 2.0;
@@ -126,53 +94,14 @@ void Light::paint(QPainter *p, const QRectF& boundingRect, const QPointF& mouseP
 	p->setClipping(false);
 }
 
-void Light::startAnimation(AnimationType animation, int duration, bool repeater) {
-	m_count = 0;
-	m_currentAnimationDuration = duration;
+void Light::startAnimation(AnimationType animation, int fps, int duration, bool repeater) {
 	m_currentAnimation = animation;
-
-	m_animationRepeater->setInterval(duration);
-	m_animationRepeater->start();
-
-	repeatAnimation();
-
-	m_repeater = repeater;
-	connect(m_animationRepeater, SIGNAL(timeout()), this, SLOT(repeatAnimation()));
+	m_animation->start(duration, fps, repeater);
 }
 
 void Light::stopAnimation() {
-	m_animationRepeater->stop();
 	m_currentAnimation = NoAnimation;
-	Plasma::Animator::self()->stopCustomAnimation(m_animation);
-	m_animation = 0;
-}
-
-void Light::repeatAnimation() {
-	if (!m_repeater && m_count != 0) {
-		return;
-	}
-
-	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
-		m_animation = 0;
-	}
-	int frames = m_item->applet()->fps() * m_currentAnimationDuration / 1000;
-
-	if (frames <= 0) {
-		animation(1.0);
-	}
-	else {
-		m_animation = Plasma::Animator::self()->customAnimation(
-			frames, m_currentAnimationDuration,
-			Plasma::Animator::LinearCurve,
-			this, "animation");
-	}
-	++ m_count;
-}
-
-void Light::animation(qreal progress) {
-	m_progress = progress;
-	emit update();
+	m_animation->stop();
 }
 
 } // namespace SmoothTasks
@@ -22,17 +22,17 @@
 
 // Qt
 #include <QObject>
-#include <QPixmap>
-#include <QIcon>
+#include <QColor>
 
-class QRadialGradient;
-class QTimer;
-class QStyleOptionGraphicsItem;
+class QPainter;
+class QPointF;
+class QRectF;
 
 namespace SmoothTasks {
 
-class TaskItem;
+class PulseAnimation;
 
+// Needs neither Plasma nor the TaskItem, so the soak test runs it as is.
 class Light : public QObject {
 	Q_OBJECT
 
@@ -43,29 +43,19 @@ public:
 		AttentionAnimation
 	};
 
-	Light(TaskItem *item);
-	~Light();
+	Light(QObject *parent = NULL);
 
-	void paint(QPainter *p, const QRectF& geometry, const QPointF& mousePos, bool mouseIn, const bool isRotated);
+	// mousePos is in the coordinates of geometry, rotated like it
+	void paint(QPainter *p, const QRectF& geometry, const QPointF& mousePos, bool mouseIn, const QColor& color);
 
 public slots:
-	void startAnimation(AnimationType animation, int duration = 300, bool repeater = true);
+	void startAnimation(AnimationType animation, int fps, int duration = 300, bool repeater = true);
 	void stopAnimation();
-	void repeatAnimation();
-
-private slots:
-	void animation(qreal progress);
 
 private:
-	TaskItem     *m_item;
-	int           m_count;
-	int           m_currentAnimationDuration;
-	int           m_animation;
-	qreal         m_progress;
-	bool          m_move;
-	AnimationType m_currentAnimation;
-	QTimer       *m_animationRepeater;
-	bool          m_repeater;
+	PulseAnimation *m_animation;
+	bool            m_move;
+	AnimationType   m_currentAnimation;
 
 signals:
 	void update();
@@ -39,8 +39,7 @@ void   LimitSqueezeTaskbarLayout::setPreferGrouping(bool preferGrouping) {
 
 int LimitSqueezeTaskbarLayout::optimumCapacity() const {
 	const QRectF effectiveRect(effectiveGeometry());
-	const QList<TaskbarItem*> & items = this->items();
-	const int N                 = items.size();
+	const int N                 = count();
 	const bool isVertical       = orientation() == Qt::Vertical;
 	const qreal availableHeight = isVertical ? effectiveRect.width()  : effectiveRect.height();
 	const qreal availableWidth  = isVertical ? effectiveRect.height() : effectiveRect.width();
@@ -53,9 +52,9 @@ int LimitSqueezeTaskbarLayout::optimumCapacity() const {
 	int cellHeight = CELL_HEIGHT(m_rows);
 	int cellWidth  = cellHeight * aspectRatio();
 	
-	for (int i =0; i < items.size(); i++) {
+	for (int i =0; i < N; i++) {
 		thisRowWidth += this->spacing() + itemAt(i)->task()->taskCount() * (cellWidth +
-			(itemAt(i)->isExpanded()) * expandedWidth());
+			isExpandedAt(i) * expandedWidth());
 		
 		if (itemAt(i)->task()->type() == Task::GroupItem) {
 			++ numberGrouped;
@@ -77,13 +76,71 @@ int LimitSqueezeTaskbarLayout::optimumCapacity() const {
 	}
 }
 
+qreal LimitSqueezeTaskbarLayout::ungroupedCompression() const {
+	const QRectF effectiveRect(effectiveGeometry());
+	const int N                 = count();
+	const bool isVertical       = orientation() == Qt::Vertical;
+	const qreal availableHeight = isVertical ? effectiveRect.width()  : effectiveRect.height();
+	const qreal availableWidth  = isVertical ? effectiveRect.height() : effectiveRect.width();
+	const qreal spacing         = this->spacing();
+	const int   rows            = maximumRows();
+	const qreal cellWidth       = (((availableHeight + spacing) / ((qreal) rows)) - spacing) * aspectRatio();
+	int taskCount               = 0;
+
+	// every task in its own item, all rows used and nothing expanded, so
+	// neither the grouping nor hovering changes it
+	for (int i = 0; i < N; ++ i) {
+		taskCount += itemAt(i)->task()->taskCount();
+	}
+
+	return (rows * availableWidth) / (taskCount * (cellWidth + spacing));
+}
+
+bool LimitSqueezeTaskbarLayout::isRowFull(
+		int startIndex, int index, qreal cellWidth, qreal spacing,
+		qreal availableWidth, qreal compression) const {
+	const qreal thisRowWidth = (index - startIndex) * (cellWidth + spacing) +
+		persistentExpandedCount(startIndex, index + 1) * expandedWidth();
+
+	// the 0.9 is here to prefer higher rows
+	return availableWidth < compression * thisRowWidth * 0.9;
+}
+
+int LimitSqueezeTaskbarLayout::rowBreak(
+		int startIndex, int N, qreal cellWidth, qreal spacing,
+		qreal availableWidth, qreal compression) const {
+	int first = startIndex;
+	int last  = N;
+
+	if (cellWidth + spacing < 0.0 || compression < 0.0) {
+		// degenerated geometry, the row width and the limit are not monotonic
+		while (first < last && !isRowFull(startIndex, first, cellWidth, spacing, availableWidth, compression)) {
+			++ first;
+		}
+		return first;
+	}
+
+	// the row gets wider with every item, so the first item that does not fit
+	// can be found by binary search
+	while (first < last) {
+		const int index = first + (last - first) / 2;
+
+		if (isRowFull(startIndex, index, cellWidth, spacing, availableWidth, compression)) {
+			last = index;
+		}
+		else {
+			first = index + 1;
+		}
+	}
+
+	return first;
+}
+
 void LimitSqueezeTaskbarLayout::doLayout() {
-	// I think this way the loops can be optimized by the compiler.
-	// (lifting out the comparison and making two loops; TODO: find out whether this is true):
 	const bool isVertical = orientation() == Qt::Vertical;
 
-	const QList<TaskbarItem*>& items = this->items();
-	const int N = items.size();
+	const QVector<qreal>& expansions = this->expansions();
+	const int N = count();
 
 	// if there is nothing to layout fill in some dummy data and leave
 	if (N == 0) {
@@ -101,10 +158,7 @@ void LimitSqueezeTaskbarLayout::doLayout() {
 
 		QSizeF newPreferredSize(qMin(10.0, rect.width()), qMin(10.0, rect.height()));
 
-		if (newPreferredSize != m_preferredSize) {
-			m_preferredSize = newPreferredSize;
-			emit sizeHintChanged(Qt::PreferredSize);
-		}
+		setPreferredSize(newPreferredSize);
 
 		return;
 	}
@@ -119,32 +173,19 @@ void LimitSqueezeTaskbarLayout::doLayout() {
 	qreal cellHeight = 0.0;
 	qreal cellWidth  = 0.0;
 
-	QList<RowInfo> rowInfos;
-	
 	qreal maxPreferredRowWidth   = 0.0;
 	qreal compression            = 1.0;
 	qreal thisRowWidth           = 0.0;
-	int   expandedHoverItemCount = 0;   // if there is some icon expanded by mouse
-	int   expandedItemCount      = 0;
-	
-	for (int index = 0; index < N; ++ index) {
-		// icon is hovered by mouse
-		if (itemAt(index)->isExpandedByHover()) {
-			++ expandedHoverItemCount;
-		}
 
-		if (itemAt(index)->isExpanded()) {
-			++ expandedItemCount;
-		}
-	}
+	// suppress the expansion by hover
+	const int persistentItemCount = persistentExpandedCount(0, N);
 
 	// determine the number of rows
 	while (rows < maximumRows()) {
 		++ rows;
 		cellHeight = CELL_HEIGHT(rows);
 		cellWidth  = cellHeight * aspectRatio();
-		thisRowWidth = N * (cellWidth + spacing) +
-			(expandedItemCount - expandedHoverItemCount) * expandedWidth(); // suppress the expansion by hover
+		thisRowWidth = N * (cellWidth + spacing) + persistentItemCount * expandedWidth();
 		compression = qMin((rows * availableWidth) / thisRowWidth, 1.0);
 		
 		if (rows * availableWidth > (thisRowWidth - N * cellWidth) * m_squeezeRatio + N * cellWidth / (rows + 1)) {
@@ -160,34 +201,18 @@ void LimitSqueezeTaskbarLayout::doLayout() {
 
 	int startIndex = 0;
 	int endIndex   = 0;
-	int index      = 0;
+
+	clearRows();
 	for (int row = 0; row < rows && endIndex < N; ++ row) {
 		startIndex = endIndex;
-		
-		expandedHoverItemCount = 0;
-		expandedItemCount      = 0;
-		// determine number of items in one row
-		for (index = startIndex; index < N; ++ index) {
-			if (itemAt(index)->isExpandedByHover()) {
-				++ expandedHoverItemCount;
-			}
-
-			if (itemAt(index)->isExpanded()) {
-				++ expandedItemCount;
-			}
-
-			thisRowWidth = (index - startIndex) * (cellWidth + spacing) +
-				(expandedItemCount - expandedHoverItemCount) * expandedWidth();
-			// the 0.9 is here to prefer higher rows
-			if (availableWidth < compression * thisRowWidth * 0.9) {
-				break;
-			}
-		}
 
 		if (row + 1 == rows) {
 			endIndex = N;
 		}
 		else {
+			// determine number of items in one row
+			int index = rowBreak(startIndex, N, cellWidth, spacing, availableWidth, compression);
+
 			if (startIndex == index) { // prevents empty rows
 				++ index;
 			}
@@ -200,7 +225,7 @@ void LimitSqueezeTaskbarLayout::doLayout() {
 		qreal thisRowMinWidth = 0.0;
 		
 		for (int index = startIndex; index < endIndex; ++ index) {
-			thisRowWidth    += cellWidth + items[index]->expansion;
+			thisRowWidth    += cellWidth + expansions[index];
 			thisRowMinWidth += cellWidth;
 		}
 
@@ -209,16 +234,16 @@ void LimitSqueezeTaskbarLayout::doLayout() {
 		}
 
 		if (startIndex != endIndex) {
-			rowInfos.append(RowInfo(thisRowWidth, thisRowMinWidth, startIndex, endIndex));
+			appendRow(RowInfo(thisRowWidth, thisRowMinWidth, startIndex, endIndex, rowSpacing));
 		}
 	}
 
 	// if we assumed expanded there still might be empty row
 	// therefore just scale up the layout (maybe do only this and not the other way of row removal)
-	rows = qMax(minimumRows(), rowInfos.size());
+	rows = qMax(minimumRows(), rowInfoCount());
 	
 	cellHeight = CELL_HEIGHT(rows);
-	updateLayout(rows, cellWidth, cellHeight, availableWidth, maxPreferredRowWidth, rowInfos, effectiveRect);
+	updateLayout(rows, cellWidth, cellHeight, availableWidth, maxPreferredRowWidth, effectiveRect);
 	
 	m_rows = rows;
 	m_compresion = compression;
@@ -49,11 +49,21 @@ class LimitSqueezeTaskbarLayout : public TaskbarLayout {
 		
 		virtual TaskbarLayoutType type() const { return LimitSqueeze; }
 		virtual int optimumCapacity() const;
+		virtual qreal ungroupedCompression() const;
 
 	protected:
 		virtual void doLayout();
 
 	private:
+		// whether the row starting at startIndex is too wide with the item at index
+		bool isRowFull(
+			int startIndex, int index, qreal cellWidth, qreal spacing,
+			qreal availableWidth, qreal compression) const;
+		// the first item that does not fit into the row starting at startIndex
+		int  rowBreak(
+			int startIndex, int N, qreal cellWidth, qreal spacing,
+			qreal availableWidth, qreal compression) const;
+
 		qreal m_squeezeRatio;
 		qreal m_compresion;
 		bool  m_preferGrouping;
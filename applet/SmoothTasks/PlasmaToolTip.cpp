@@ -42,10 +42,11 @@ void PlasmaToolTip::unregisterItem(TaskItem *item) {
 void PlasmaToolTip::showAction(bool animate) {
 	Q_UNUSED(animate);
 	
-//	qDebug("connect windowPreviewActivated");
+	// hide() keeps the connection, so connect only once
 	connect(Plasma::ToolTipManager::self(),
 		SIGNAL(windowPreviewActivated(WId,Qt::MouseButtons,Qt::KeyboardModifiers,QPoint)),
-		this, SLOT(activateWindow(WId,Qt::MouseButtons))); 
+		this, SLOT(activateWindow(WId,Qt::MouseButtons)),
+		Qt::UniqueConnection);
 		
 	updateToolTip();
 	Plasma::ToolTipManager::self()->show(m_hoverItem); 
@@ -0,0 +1,60 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#include "SmoothTasks/PulseAnimation.h"
+#include "SmoothTasks/AnimationDriver.h"
+
+namespace SmoothTasks {
+
+PulseAnimation::PulseAnimation(QObject *parent)
+		: QObject(parent),
+		  m_animation(0),
+		  m_progress(0.0) {
+}
+
+PulseAnimation::~PulseAnimation() {
+	stop();
+}
+
+// Repeated animations are beats of the AnimationDriver, so all items that
+// demand attention pulse together and no timer per item is needed.
+void PulseAnimation::start(int duration, int fps, bool repeater) {
+	AnimationDriver *driver = AnimationDriver::self();
+
+	stop();
+	m_progress  = 0.0;
+	m_animation = repeater ?
+		driver->startBeat(duration, fps, this, "animate") :
+		driver->start(duration, fps, this, "animate");
+}
+
+void PulseAnimation::stop() {
+	if (m_animation) {
+		AnimationDriver::self()->stop(m_animation);
+		m_animation = 0;
+	}
+}
+
+void PulseAnimation::animate(qreal progress) {
+	m_progress = progress;
+	emit update();
+}
+
+} // namespace SmoothTasks
+#include "PulseAnimation.moc"
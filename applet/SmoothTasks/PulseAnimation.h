@@ -0,0 +1,58 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_PULSEANIMATION_H
+#define SMOOTHTASKS_PULSEANIMATION_H
+
+#include <QObject>
+
+namespace SmoothTasks {
+
+// The animation of the light and the startup animation of the icon: a
+// progress from 0 to 1 ticked by the AnimationDriver, once or repeated as a
+// beat. Starting it again replaces the track, so it can be restarted with
+// every state change of an item without piling up tracks or connections.
+class PulseAnimation : public QObject {
+	Q_OBJECT
+
+public:
+	PulseAnimation(QObject *parent = NULL);
+	~PulseAnimation();
+
+	qreal progress() const { return m_progress; }
+	// started and not stopped, a finished animation stays at 1
+	bool  isActive() const { return m_animation != 0; }
+
+public slots:
+	void start(int duration, int fps, bool repeater);
+	void stop();
+
+private slots:
+	void animate(qreal progress);
+
+signals:
+	void update();
+
+private:
+	int   m_animation;
+	qreal m_progress;
+};
+
+} // namespace SmoothTasks
+#endif
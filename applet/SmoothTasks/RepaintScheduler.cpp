@@ -0,0 +1,122 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "SmoothTasks/RepaintScheduler.h"
+#include "SmoothTasks/AnimationDriver.h"
+
+#include <QGraphicsItem>
+
+namespace SmoothTasks {
+
+RepaintScheduler::RepaintScheduler(QObject *parent)
+		: QObject(parent),
+		  m_ticker(0),
+		  m_fps(25),
+		  m_dirty(),
+		  m_secondStart(0),
+		  m_frames(0),
+		  m_coalesced(0),
+		  m_lastFrames(0),
+		  m_lastCoalesced(0),
+		  m_frameCount(0),
+		  m_repaintCount(0),
+		  m_coalescedCount(0) {
+}
+
+RepaintScheduler::~RepaintScheduler() {
+	AnimationDriver::self()->stop(m_ticker);
+}
+
+void RepaintScheduler::setFps(int fps) {
+	if (fps <= 0) {
+		qWarning("RepaintScheduler::setFps: invalid fps %d", fps);
+		return;
+	}
+
+	m_fps = fps;
+}
+
+void RepaintScheduler::schedule(QGraphicsItem *item) {
+	if (item == NULL) {
+		qWarning("RepaintScheduler::schedule: cannot schedule null item");
+		return;
+	}
+
+	if (m_dirty.contains(item)) {
+		++ m_coalesced;
+		++ m_coalescedCount;
+		return;
+	}
+	m_dirty.insert(item);
+
+	// Tickers run after the other tracks of a frame, so whatever the
+	// animations of a frame request is repainted in that same frame.
+	if (m_ticker == 0) {
+		m_ticker = AnimationDriver::self()->startTicker(m_fps, this, "flush");
+	}
+}
+
+void RepaintScheduler::cancel(QGraphicsItem *item) {
+	m_dirty.remove(item);
+}
+
+void RepaintScheduler::closeSecond(qint64 now) {
+	// a second without any frames in between counts nothing
+	const bool follows = now - m_secondStart < 2000;
+
+	m_lastFrames    = follows ? m_frames    : 0;
+	m_lastCoalesced = follows ? m_coalesced : 0;
+	m_frames        = 0;
+	m_coalesced     = 0;
+	m_secondStart   = now;
+
+	if (m_lastFrames > 0) {
+		emit secondEnded();
+	}
+}
+
+void RepaintScheduler::flush() {
+	if (m_dirty.isEmpty()) {
+		// stay idle until the next request
+		AnimationDriver::self()->stop(m_ticker);
+		m_ticker = 0;
+		return;
+	}
+
+	const qint64 now = AnimationDriver::self()->clock()->now();
+
+	if (now - m_secondStart >= 1000) {
+		closeSecond(now);
+	}
+
+	// QGraphicsItem::update() only marks the item, so nothing can be
+	// scheduled while the items are walked
+	foreach (QGraphicsItem *item, m_dirty) {
+		item->update();
+	}
+
+	m_repaintCount += m_dirty.size();
+	m_dirty.clear();
+	++ m_frames;
+	++ m_frameCount;
+}
+
+} // namespace SmoothTasks
+#include "RepaintScheduler.moc"
@@ -0,0 +1,87 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_REPAINTSCHEDULER_H
+#define SMOOTHTASKS_REPAINTSCHEDULER_H
+
+#include <QObject>
+#include <QSet>
+
+class QGraphicsItem;
+
+namespace SmoothTasks {
+
+// Collects the items that have to be repainted and repaints them together at
+// the end of the next frame of the AnimationDriver. So the scene gets one
+// batch of updates per frame, in step with the animations, instead of one
+// update per item whenever its own timer fires. Further requests of an item
+// that already waits for the frame are coalesced.
+class RepaintScheduler : public QObject {
+	Q_OBJECT
+
+public:
+	RepaintScheduler(QObject *parent = NULL);
+	~RepaintScheduler();
+
+	void schedule(QGraphicsItem *item);
+	// has to be called before a scheduled item is deleted
+	void cancel(QGraphicsItem *item);
+	bool isScheduled(QGraphicsItem *item) const { return m_dirty.contains(item); }
+
+	// the frame rate of the applet, takes effect with the next request
+	int  fps() const { return m_fps; }
+	void setFps(int fps);
+
+	// frames that repainted something and requests that were coalesced in
+	// the last second that had any, so framesLastSecond() is the achieved fps
+	int framesLastSecond()    const { return m_lastFrames; }
+	int coalescedLastSecond() const { return m_lastCoalesced; }
+
+	qint64 frameCount()     const { return m_frameCount; }
+	qint64 repaintCount()   const { return m_repaintCount; }
+	qint64 coalescedCount() const { return m_coalescedCount; }
+
+signals:
+	// a second with repaints ended
+	void secondEnded();
+
+private slots:
+	void flush();
+
+private:
+	void closeSecond(qint64 now);
+
+	// ticker of the AnimationDriver, 0 if stopped
+	int                     m_ticker;
+	int                     m_fps;
+
+	QSet<QGraphicsItem*>    m_dirty;
+
+	qint64                  m_secondStart;
+	int                     m_frames;
+	int                     m_coalesced;
+	int                     m_lastFrames;
+	int                     m_lastCoalesced;
+	qint64                  m_frameCount;
+	qint64                  m_repaintCount;
+	qint64                  m_coalescedCount;
+};
+
+} // namespace SmoothTasks
+#endif
@@ -0,0 +1,232 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Smooth Tasks
+#include "SmoothTasks/ShadowBlur.h"
+
+// Qt
+#include <QColor>
+#include <QVector>
+
+// STD C++
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace SmoothTasks {
+
+namespace {
+
+// the precisions of expblur<16, 7>: the factor has 16 fractional bits and the
+// running value 7 more than the pixels
+const int APREC = 16;
+const int ZPREC = 7;
+
+// the alpha channel of the last image, only grows
+QVector<uchar> alphaBuffer;
+
+inline void blurPixel(uchar *pixel, int& z, int factor) {
+	z += (factor * ((int(*pixel) << ZPREC) - z)) >> APREC;
+	*pixel = uchar(z >> ZPREC);
+}
+
+// x * a / 255 for all channels of a premultiplied pixel, rounded like the
+// raster engine of Qt does it
+inline quint32 byteMul(quint32 x, quint32 a) {
+	quint32 t = (x & 0xff00ff) * a;
+	t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+	t &= 0xff00ff;
+
+	x = ((x >> 8) & 0xff00ff) * a;
+	x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+	x &= 0xff00ff00;
+
+	return x | t;
+}
+
+} // namespace
+
+void ShadowBlur::apply(QImage& image, int radius, const QColor& color) {
+	if (radius < 1 || image.isNull()) {
+		return;
+	}
+
+	if (image.format() != QImage::Format_ARGB32_Premultiplied) {
+		image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+	}
+
+	const int width  = image.width();
+	const int height = image.height();
+
+	if (alphaBuffer.size() < width * height) {
+		alphaBuffer.resize(width * height);
+	}
+	uchar *alpha = alphaBuffer.data();
+
+	for (int y = 0; y < height; ++ y) {
+		const QRgb *line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+		uchar      *row  = alpha + y * width;
+
+		for (int x = 0; x < width; ++ x) {
+			row[x] = uchar(line[x] >> 24);
+		}
+	}
+
+	blurAlpha(alpha, width, height, width, radius);
+
+	// like filling the image with the color in CompositionMode_SourceIn
+	const quint32 fill = byteMul(quint32(color.rgba()) | 0xff000000, color.alpha());
+
+	for (int y = 0; y < height; ++ y) {
+		QRgb        *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+		const uchar *row  = alpha + y * width;
+
+		for (int x = 0; x < width; ++ x) {
+			line[x] = byteMul(fill, row[x]);
+		}
+	}
+}
+
+void ShadowBlur::blurAlpha(uchar *alpha, int width, int height, int stride, int radius) {
+	if (radius < 1) {
+		return;
+	}
+
+	const int factor = factorFor(radius);
+	blurRows(alpha, width, height, stride, factor);
+	blurColumns(alpha, width, height, stride, factor);
+}
+
+int ShadowBlur::factorFor(int radius) {
+	// 90% of the kernel are within the radius, like in expblur()
+	return int((1 << APREC) * (1.0f - std::exp(-2.3f / (radius + 1.f))));
+}
+
+void ShadowBlur::blurRows(uchar *alpha, int width, int height, int stride, int factor) {
+	for (int y = 0; y < height; ++ y) {
+		uchar *row = alpha + y * stride;
+		int    z   = int(row[0]) << ZPREC;
+
+		for (int x = 1; x < width; ++ x) {
+			blurPixel(row + x, z, factor);
+		}
+
+		for (int x = width - 2; x >= 0; -- x) {
+			blurPixel(row + x, z, factor);
+		}
+	}
+}
+
+void ShadowBlur::blurColumns(uchar *alpha, int width, int height, int stride, int factor) {
+#ifdef __SSE2__
+	blurColumnsSse2(alpha, width, height, stride, factor);
+#else
+	blurColumnsScalar(alpha, width, height, stride, factor);
+#endif
+}
+
+const char *ShadowBlur::kernelName() {
+#ifdef __SSE2__
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+// Like expblur() the way down stops before the last row, so that one is only
+// blurred along the row.
+void ShadowBlur::blurColumnsScalar(uchar *alpha, int width, int height, int stride, int factor) {
+	for (int x = 0; x < width; ++ x) {
+		uchar *column = alpha + x;
+		int    z      = int(column[0]) << ZPREC;
+
+		for (int y = 1; y < height - 1; ++ y) {
+			blurPixel(column + y * stride, z, factor);
+		}
+
+		for (int y = height - 2; y >= 0; -- y) {
+			blurPixel(column + y * stride, z, factor);
+		}
+	}
+}
+
+#ifdef __SSE2__
+namespace {
+
+// One step of blurPixel() for eight columns. The running values fit 15 bits
+// and the differences 16, so the product only needs its high half. The factor
+// can be above 32767, then it is multiplied as factor - 65536 and the
+// difference added back.
+inline __m128i blurStep(__m128i z, __m128i pixels, __m128i factor, bool wideFactor) {
+	const __m128i difference = _mm_sub_epi16(_mm_slli_epi16(pixels, ZPREC), z);
+	__m128i step = _mm_mulhi_epi16(difference, factor);
+
+	if (wideFactor) {
+		step = _mm_add_epi16(step, difference);
+	}
+
+	return _mm_add_epi16(z, step);
+}
+
+inline void blurSixteen(uchar *pixel, __m128i& low, __m128i& high, __m128i factor, bool wideFactor) {
+	const __m128i zero   = _mm_setzero_si128();
+	const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixel));
+
+	low  = blurStep(low,  _mm_unpacklo_epi8(pixels, zero), factor, wideFactor);
+	high = blurStep(high, _mm_unpackhi_epi8(pixels, zero), factor, wideFactor);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), _mm_packus_epi16(
+		_mm_srli_epi16(low,  ZPREC),
+		_mm_srli_epi16(high, ZPREC)));
+}
+
+} // namespace
+
+// Sixteen columns at a time, one 16 bit lane per column.
+void ShadowBlur::blurColumnsSse2(uchar *alpha, int width, int height, int stride, int factor) {
+	const bool    wideFactor = factor > 32767;
+	const __m128i factorVec  = _mm_set1_epi16(short(wideFactor ? factor - 65536 : factor));
+	const __m128i zero       = _mm_setzero_si128();
+	const int     N          = width & ~15;
+
+	for (int x = 0; x < N; x += 16) {
+		uchar  *column = alpha + x;
+		__m128i first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column));
+		__m128i low    = _mm_slli_epi16(_mm_unpacklo_epi8(first, zero), ZPREC);
+		__m128i high   = _mm_slli_epi16(_mm_unpackhi_epi8(first, zero), ZPREC);
+
+		for (int y = 1; y < height - 1; ++ y) {
+			blurSixteen(column + y * stride, low, high, factorVec, wideFactor);
+		}
+
+		for (int y = height - 2; y >= 0; -- y) {
+			blurSixteen(column + y * stride, low, high, factorVec, wideFactor);
+		}
+	}
+
+	if (N < width) {
+		blurColumnsScalar(alpha + N, width - N, height, stride, factor);
+	}
+}
+#endif
+
+} // namespace SmoothTasks
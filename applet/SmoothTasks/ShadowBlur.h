@@ -0,0 +1,63 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_SHADOWBLUR_H
+#define SMOOTHTASKS_SHADOWBLUR_H
+
+#include <QImage>
+
+class QColor;
+
+namespace SmoothTasks {
+
+// The text shadows of Plasma::PaintUtils::shadowBlur() without its cost: the
+// exponential blur of kdelibs (expblur<16, 7>) is run on the alpha channel
+// only, because the color replaces the others anyway. The results are the
+// same as those of PaintUtils.
+//
+// The blur runs in a buffer that is kept for the next call, so it must only
+// be used from the GUI thread.
+class ShadowBlur {
+
+public:
+	// Blurs the alpha of image by radius and fills it with color. The image
+	// becomes premultiplied ARGB32. Nothing is done if radius is below 1.
+	static void apply(QImage& image, int radius, const QColor& color);
+
+	// Blurs an 8 bit alpha buffer in place.
+	static void blurAlpha(uchar *alpha, int width, int height, int stride, int radius);
+
+	// The passes of blurAlpha(). factor is the fixed point weight of the
+	// next pixel, see factorFor(). The columns can be done with SIMD, as
+	// all of them advance together row by row; every row depends on the
+	// pixel before, so they are done one after the other.
+	static int  factorFor(int radius);
+	static void blurRows(uchar *alpha, int width, int height, int stride, int factor);
+	static void blurColumns(uchar *alpha, int width, int height, int stride, int factor);
+	static void blurColumnsScalar(uchar *alpha, int width, int height, int stride, int factor);
+#ifdef __SSE2__
+	static void blurColumnsSse2(uchar *alpha, int width, int height, int stride, int factor);
+#endif
+
+	// name of the kernel used by blurColumns()
+	static const char *kernelName();
+};
+
+} // namespace SmoothTasks
+#endif
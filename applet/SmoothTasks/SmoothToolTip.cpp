@@ -24,6 +24,8 @@
 #include "SmoothTasks/WindowPreview.h"
 #include "SmoothTasks/TaskItem.h"
 #include "SmoothTasks/Task.h"
+#include "SmoothTasks/AnimationDriver.h"
+#include "SmoothTasks/WakeupMonitor.h"
 
 #include <Plasma/Theme>
 #include <Plasma/IconWidget>
@@ -66,10 +68,6 @@ SmoothToolTip::SmoothToolTip(Applet *applet)
 	  m_closeIcon(),
 	  m_hoverCloseIcon() {
 	
-	connect(
-		Plasma::Animator::self(), SIGNAL(customAnimationFinished(int)),
-		this, SLOT(animationFinished(int)));
-
 	connect(
 		applet, SIGNAL(mouseEnter()),
 		this, SLOT(stopEffect()));
@@ -85,6 +83,7 @@ SmoothToolTip::SmoothToolTip(Applet *applet)
 	m_highlightDelay->setSingleShot(true);
 	
 	connect(m_highlightDelay, SIGNAL(timeout()), this, SLOT(highlightDelayTimeout()));
+	WakeupMonitor::self()->watch(m_highlightDelay, "SmoothToolTip");
 	connect(m_background, SIGNAL(repaintNeeded()), this, SLOT(updateTheme()));
 	connect(
 		m_applet, SIGNAL(previewLayoutChanged(Applet::PreviewLayoutType)),
@@ -265,7 +264,7 @@ void SmoothToolTip::moveTo(WindowPreview *preview, const QPoint& mousePos) {
 
 void SmoothToolTip::startScrollAnimation(int dx, int dy, int duration) {
 	if (m_scrollAnimation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_scrollAnimation);
+		AnimationDriver::self()->stop(m_scrollAnimation);
 		m_scrollAnimation = 0;
 	}
 
@@ -281,10 +280,8 @@ void SmoothToolTip::startScrollAnimation(int dx, int dy, int duration) {
 		animationFinished(m_scrollAnimation);
 	}
 	else {
-		m_scrollAnimation = Plasma::Animator::self()->customAnimation(
-			frames, duration,
-			Plasma::Animator::LinearCurve,
-			this, "animateScroll");
+		m_scrollAnimation = AnimationDriver::self()->start(
+			duration, m_applet->fps(), this, "animateScroll", "animationFinished");
 	}
 }
 
@@ -307,7 +304,7 @@ void SmoothToolTip::animationFinished(int animation) {
 void SmoothToolTip::stopScrollAnimation(bool force) {
 	if (force || !m_moveAnimation) {
 		if (m_scrollAnimation) {
-			Plasma::Animator::self()->stopCustomAnimation(m_scrollAnimation);
+			AnimationDriver::self()->stop(m_scrollAnimation);
 		}
 		m_scrollAnimation      = 0;
 		m_dx                   = 0;
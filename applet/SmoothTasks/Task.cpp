@@ -319,13 +319,18 @@ void Task::setWindowTask(TaskManager::TaskItem* taskItem) {
 	m_task = taskItem;
 	m_abstractItem = qobject_cast<TaskManager::AbstractGroupableItem *>(taskItem);
 	
+	// a startup item gets here with the item it already was connected to
 	if (m_abstractItem) {
-		connect(m_abstractItem, SIGNAL(destroyed(QObject*)), this, SLOT(itemDestroyed()));
+		connect(
+			m_abstractItem, SIGNAL(destroyed(QObject*)),
+			this, SLOT(itemDestroyed()),
+			Qt::UniqueConnection);
 	}
 	
 	connect(
 		m_task, SIGNAL(changed(::TaskManager::TaskChanges)),
-		this, SLOT(updateTask(::TaskManager::TaskChanges)));
+		this, SLOT(updateTask(::TaskManager::TaskChanges)),
+		Qt::UniqueConnection);
 	
 	updateTask(::TaskManager::EverythingChanged);
 	
@@ -23,9 +23,10 @@
 #include "SmoothTasks/TaskIcon.h"
 #include "SmoothTasks/TaskItem.h"
 #include "SmoothTasks/Applet.h"
+#include "SmoothTasks/PulseAnimation.h"
+#include "SmoothTasks/Global.h"
 
 // Qt
-#include <QTimer>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
 #include <QFont>
@@ -33,35 +34,36 @@
 
 // Plasma
 #include <Plasma/Applet>
-#include <Plasma/PaintUtils>
 
 // KDE
 #include <KIcon>
 #include <KIconEffect>
 #include <KIconLoader>
+#include <KGlobalSettings>
 
 // Std C++
 #include <iterator>
 
 namespace SmoothTasks {
 
+const int TaskIcon::VARIANT_SIZE_STEP = 2;
+const int TaskIcon::MAX_VARIANT_SIZES = 8;
+
 TaskIcon::TaskIcon(TaskItem *item)
 	: QObject(item),
 	 m_item(item),
 	 m_icon(),
 	 m_highlightColor(0),
 	 m_rect(),
-	 m_pixmap(),
-	 m_animationRepeater(new QTimer(this)),
-	 m_currentAnimationDuration(0),
-	 m_animation(0),
-	 m_progress(0.0) {
-}
-
-TaskIcon::~TaskIcon() {
-	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
-	}
+	 m_variants(MAX_VARIANT_SIZES),
+	 m_hoverFade(),
+	 m_startup(new PulseAnimation(this)) {
+	connect(m_startup, SIGNAL(update()), this, SIGNAL(update()));
+
+	// the active effect is configured with the icons
+	connect(
+		KGlobalSettings::self(), SIGNAL(iconChanged(int)),
+		this, SLOT(clearVariants()));
 }
 
 QRgb TaskIcon::highlightColor() const {
@@ -75,7 +77,7 @@ QRgb TaskIcon::highlightColor() const {
 }
 
 void TaskIcon::updatePos() {
-	qreal size     = this->size();
+	int   size     = quantizedSize();
 	QSize iconSize = m_icon.actualSize(QSize(size, size));
 	QRectF boundingRect;
 	const QSizeF& cellSize(m_item->cellSize());
@@ -109,35 +111,155 @@ void TaskIcon::updatePos() {
 }
 
 void TaskIcon::paint(QPainter *p, qreal hover, bool isGroup) {
-	m_pixmap = m_icon.pixmap(size());
+	Variants      *variants = this->variants(quantizedSize());
+	const QPixmap& normal   = variant(*variants, isGroup ? NormalGroup : Normal);
 
-	if (m_pixmap.isNull()) {
+	if (normal.isNull()) {
 		kDebug() << "TaskIcon pixmap is null";
 		return;
 	}
 
-	if (m_animation) {
-		animationStartup(m_progress);
+	KIconEffect *effect = KIconLoader::global()->iconEffect();
+	const bool hoverEffect = hover > 0.0 &&
+		effect->hasEffect(KIconLoader::Desktop, KIconLoader::ActiveState);
+
+	if (m_startup->isActive()) {
+		// the icon changes every frame, so it is changed as an image and
+		// only uploaded once per frame
+		QImage image(variantImage(*variants, Normal));
+		animationStartup(image, m_startup->progress());
+
+		if (hoverEffect) {
+			animationHover(image, hover);
+		}
+
+		if (isGroup) {
+			paintBadge(image, variantImage(*variants, Badge));
+		}
+		p->drawPixmap(m_pos, imageToPixmap(image));
+	}
+	else if (!hoverEffect) {
+		p->drawPixmap(m_pos, normal);
+	}
+	else if (qFuzzyCompare(qreal(1.0), hover)) {
+		p->drawPixmap(m_pos, variant(*variants, isGroup ? ActiveGroup : Active));
+	}
+	else {
+		m_hoverFade.addLayer(normal);
+		m_hoverFade.addLayer(variant(*variants, isGroup ? ActiveGroup : Active), hover);
+		p->drawImage(m_pos, m_hoverFade.render());
 	}
+}
+
+int TaskIcon::quantizedSize() const {
+	return qMax(1, qRound(size() / VARIANT_SIZE_STEP) * VARIANT_SIZE_STEP);
+}
 
-	if (hover > 0.0) {
-		animationHover(hover);
+TaskIcon::Variants *TaskIcon::variants(int size) {
+	Variants *variants = m_variants.object(size);
+
+	if (!variants) {
+		variants = new Variants(size);
+		m_variants.insert(size, variants);
+	}
+
+	return variants;
+}
+
+const QPixmap& TaskIcon::variant(Variants& variants, Variant variant) {
+	QPixmap& pixmap = variants.pixmaps[variant];
+
+	if (variants.rendered[variant]) {
+		return pixmap;
 	}
+	variants.rendered[variant] = true;
 
-	if (isGroup) {
-		QPainter iconPainter(&m_pixmap);
-		QPixmap  icon(KIcon("document-multiple").pixmap(
-			m_pixmap.width()  * 0.45,
-			m_pixmap.height() * 0.45));
+	switch (variant) {
+	case Normal:
+		pixmap = m_icon.pixmap(variants.size);
+		break;
 
-		iconPainter.drawPixmap(
-			m_pixmap.width()  - icon.width(),
-			m_pixmap.height() - icon.height(),
-			icon);
+	case Active:
+	{
+		KIconEffect *effect = KIconLoader::global()->iconEffect();
+		const QPixmap& normal = this->variant(variants, Normal);
 
-		iconPainter.end();
+		if (effect->hasEffect(KIconLoader::Desktop, KIconLoader::ActiveState) && !normal.isNull()) {
+			pixmap = imageToPixmap(effect->apply(
+				pixmapToImage(normal),
+				KIconLoader::Desktop,
+				KIconLoader::ActiveState));
+		}
+		else {
+			pixmap = normal;
+		}
+		break;
+	}
+	case Badge:
+	{
+		const QPixmap& normal = this->variant(variants, Normal);
+		pixmap = KIcon("document-multiple").pixmap(
+			normal.width()  * 0.45,
+			normal.height() * 0.45);
+		break;
+	}
+	case NormalGroup:
+		pixmap = this->variant(variants, Normal);
+		paintBadge(pixmap, this->variant(variants, Badge));
+		break;
+
+	case ActiveGroup:
+		pixmap = this->variant(variants, Active);
+		paintBadge(pixmap, this->variant(variants, Badge));
+		break;
+
+	default:
+		break;
 	}
-	p->drawPixmap(m_pos, m_pixmap);
+
+	return pixmap;
+}
+
+const QImage& TaskIcon::variantImage(Variants& variants, Variant variant) {
+	QImage& image = variants.images[variant];
+
+	if (!variants.converted[variant]) {
+		variants.converted[variant] = true;
+		image = pixmapToImage(this->variant(variants, variant))
+			.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+	}
+
+	return image;
+}
+
+void TaskIcon::paintBadge(QPixmap& pixmap, const QPixmap& badge) {
+	if (pixmap.isNull()) {
+		return;
+	}
+
+	QPainter painter(&pixmap);
+	painter.drawPixmap(
+		pixmap.width()  - badge.width(),
+		pixmap.height() - badge.height(),
+		badge);
+	painter.end();
+}
+
+void TaskIcon::paintBadge(QImage& image, const QImage& badge) {
+	if (image.isNull()) {
+		return;
+	}
+
+	QPainter painter(&image);
+	painter.drawImage(
+		image.width()  - badge.width(),
+		image.height() - badge.height(),
+		badge);
+	painter.end();
+}
+
+void TaskIcon::clearVariants() {
+	m_variants.clear();
 }
 
 void TaskIcon::setRect(const QRectF& rect) {
@@ -149,6 +271,7 @@ void TaskIcon::setRect(const QRectF& rect) {
 
 void TaskIcon::setIcon(const QIcon& icon) {
 	m_icon = icon;
+	clearVariants();
 	m_highlightColor = dominantColor();
 	updatePos();
 }
@@ -164,105 +287,68 @@ qreal TaskIcon::size() const {
 }
 
 void TaskIcon::startStartupAnimation(int duration) {
-	m_currentAnimationDuration = duration;
-
-	m_animationRepeater->setInterval(duration);
-	m_animationRepeater->start();
-
-	repeatAnimation();
-
-	connect(m_animationRepeater, SIGNAL(timeout()), this, SLOT(repeatAnimation()));
+	m_startup->start(duration, m_item->applet()->fps(), true);
 }
 
 void TaskIcon::stopStartupAnimation() {
-	m_animationRepeater->stop();
-
-	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
-		m_animation = 0;
-	}
-}
-
-void TaskIcon::repeatAnimation() {
-	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
-	}
-
-	m_animation = Plasma::Animator::self()->customAnimation(
-		m_item->applet()->fps() * m_currentAnimationDuration / 1000,
-		m_currentAnimationDuration,
-		Plasma::Animator::LinearCurve,
-		this, "animation");
-}
-
-void TaskIcon::animation(qreal progress) {
-	m_progress = progress;
-	emit update();
+	m_startup->stop();
 }
 
-void TaskIcon::animationHover(qreal hover) {
+void TaskIcon::animationHover(QImage& image, qreal hover) {
 	KIconEffect *effect = KIconLoader::global()->iconEffect();
+	const QImage active(effect->apply(
+		image,
+		KIconLoader::Desktop,
+		KIconLoader::ActiveState));
 
-	if (effect->hasEffect(KIconLoader::Desktop, KIconLoader::ActiveState)) {
-		if (qFuzzyCompare(qreal(1.0), hover)) {
-			m_pixmap = effect->apply(
-				m_pixmap,
-				KIconLoader::Desktop,
-				KIconLoader::ActiveState);
-		}
-		else if (hover != 0.0) {
-			m_pixmap = Plasma::PaintUtils::transition(
-				m_pixmap,
-				effect->apply(
-					m_pixmap,
-					KIconLoader::Desktop,
-					KIconLoader::ActiveState),
-				hover);
-		}
+	if (qFuzzyCompare(qreal(1.0), hover)) {
+		image = active;
+	}
+	else {
+		m_hoverFade.addLayer(image);
+		m_hoverFade.addLayer(active, hover);
+		image = m_hoverFade.render();
 	}
 }
 
-void TaskIcon::animationStartup(qreal progress) {
-	QPixmap pixmap = QPixmap(m_pixmap.width(), m_pixmap.height());
-	pixmap.fill(Qt::transparent);
+void TaskIcon::animationStartup(QImage& image, qreal progress) {
+	QImage frame(image.size(), QImage::Format_ARGB32_Premultiplied);
+	frame.fill(0);
 	int width;
 	int height;
 
 	if (progress < 0.5) {
-		width  = m_pixmap.width()  * (0.5 + progress * 0.5);
-		height = m_pixmap.height() * (1.0 - progress * 0.5);
+		width  = image.width()  * (0.5 + progress * 0.5);
+		height = image.height() * (1.0 - progress * 0.5);
 	}
 	else {
-		width  = m_pixmap.width()  * (1.0 - progress * 0.5);
-		height = m_pixmap.height() * (0.5 + progress * 0.5);
+		width  = image.width()  * (1.0 - progress * 0.5);
+		height = image.height() * (0.5 + progress * 0.5);
 	}
 
-	QPixmap scaled = m_pixmap.scaled(
+	QImage scaled = image.scaled(
 		width, height,
 		Qt::IgnoreAspectRatio,
 		Qt::SmoothTransformation);
 
 	if (!scaled.isNull()) {
-		QPainter pixmapPainter(&pixmap);
-		pixmapPainter.drawPixmap(
-			(m_pixmap.width()  - width)  / 2,
-			(m_pixmap.height() - height) / 2,
+		// like a transition from a transparent pixmap by 0.85
+		QPainter framePainter(&frame);
+		framePainter.setOpacity(0.85);
+		framePainter.drawImage(
+			(image.width()  - width)  / 2,
+			(image.height() - height) / 2,
 			scaled);
 
-
-		pixmapPainter.end();
+		framePainter.end();
 	}
-	m_pixmap = pixmap;
-
-	QPixmap transparentPixmap = QPixmap(m_pixmap.width(), m_pixmap.height());
-	transparentPixmap.fill(Qt::transparent);
-	m_pixmap = Plasma::PaintUtils::transition(transparentPixmap, m_pixmap, 0.85);
+	image = frame;
 }
 
 QRgb TaskIcon::averageColor() const {
 	// Computes, and returns average color of the icon image.
 	// Added by harsh@harshj.com for color hot-tracking support.
-	QImage image(m_icon.pixmap(size()).toImage());
+	QImage image(pixmapToImage(m_icon.pixmap(size())));
 	unsigned int r(0), g(0), b(0);
 	unsigned int count = 0;
 
@@ -308,7 +394,7 @@ static bool hsvLess(const QColor& c1, const QColor& c2) {
 }
 
 QRgb TaskIcon::meanColor() const {
-	QImage image(m_icon.pixmap(size()).toImage());
+	QImage image(pixmapToImage(m_icon.pixmap(size())));
 	QVector<QColor> colors(image.width() * image.height());
 	
 	int count = 0;
@@ -360,7 +446,7 @@ static bool isNear(const QColor& c1, const QColor& c2) {
 }
 
 QRgb TaskIcon::dominantColor() const {
-	QImage image(m_icon.pixmap(size()).toImage());
+	QImage image(pixmapToImage(m_icon.pixmap(size())));
 	QVector<QColor> colors(image.width() * image.height());
 	
 	int count = 0;
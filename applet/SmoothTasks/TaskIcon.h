@@ -23,22 +23,26 @@
 
 // Qt
 #include <QObject>
+#include <QCache>
+#include <QImage>
 #include <QPixmap>
 #include <QIcon>
 
-class QTimer;
+// Smooth Tasks
+#include "SmoothTasks/CrossFade.h"
+
 class QStyleOptionGraphicsItem;
 
 namespace SmoothTasks {
 
 class TaskItem;
+class PulseAnimation;
 
 class TaskIcon : public QObject {
 	Q_OBJECT
 
 public:
 	TaskIcon(TaskItem *item);
-	~TaskIcon();
 
 	void paint(QPainter *p, qreal hover, bool isGroup);
 	void setRect(const QRectF& geometry);
@@ -52,28 +56,64 @@ public slots:
 	void stopStartupAnimation();
 
 private slots:
-	void animation(qreal progress);
-	void repeatAnimation();
+	void clearVariants();
 
 private:
+	// the sizes of the icon are rounded to multiples of this, so resizing
+	// doesn't render the icon again at every fraction of a pixel
+	static const int VARIANT_SIZE_STEP;
+	static const int MAX_VARIANT_SIZES;
+
+	// what is rendered of the icon per size, each once when first painted
+	enum Variant {
+		Normal,
+		Active,      // with the active icon effect
+		Badge,       // the group badge for the size of the icon
+		NormalGroup, // Normal with the badge
+		ActiveGroup, // Active with the badge
+		VARIANT_COUNT
+	};
+
+	struct Variants {
+		Variants(int size) : size(size) {
+			for (int variant = 0; variant < VARIANT_COUNT; ++ variant) {
+				rendered[variant]  = false;
+				converted[variant] = false;
+			}
+		}
+
+		int     size;
+		QPixmap pixmaps[VARIANT_COUNT];
+		bool    rendered[VARIANT_COUNT];
+		// client side copies for the startup animation, which changes the
+		// icon every frame
+		QImage  images[VARIANT_COUNT];
+		bool    converted[VARIANT_COUNT];
+	};
+
 	QRgb averageColor() const;
 	QRgb meanColor() const;
 	QRgb dominantColor() const;
+
+	int            quantizedSize() const;
+	Variants      *variants(int size);
+	const QPixmap& variant(Variants& variants, Variant variant);
+	const QImage&  variantImage(Variants& variants, Variant variant);
+	static void    paintBadge(QPixmap& pixmap, const QPixmap& badge);
+	static void    paintBadge(QImage& image, const QImage& badge);
 	
-	TaskItem *m_item;
-	QIcon     m_icon;
-	QRgb      m_highlightColor;
-	QRectF    m_rect;
-	QPixmap   m_pixmap;
-	QTimer   *m_animationRepeater;
-	int       m_currentAnimationDuration;
-	int       m_animation;
-	qreal     m_progress;
-	QPointF   m_pos;
+	TaskItem                *m_item;
+	QIcon                    m_icon;
+	QRgb                     m_highlightColor;
+	QRectF                   m_rect;
+	QCache<int, Variants>    m_variants; // by quantized size
+	CrossFade                m_hoverFade;
+	PulseAnimation          *m_startup;
+	QPointF                  m_pos;
 
 	void updatePos();
-	void animationHover(qreal hover);
-	void animationStartup(qreal progress);
+	void animationHover(QImage& image, qreal hover);
+	void animationStartup(QImage& image, qreal progress);
 
 signals:
 	void update();
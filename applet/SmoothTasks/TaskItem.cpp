@@ -27,6 +27,11 @@
 #include "SmoothTasks/Global.h"
 #include "SmoothTasks/SmoothToolTip.h"
 #include "SmoothTasks/TaskbarLayout.h"
+#include "SmoothTasks/RepaintScheduler.h"
+#include "SmoothTasks/FrameRenderer.h"
+#include "SmoothTasks/LabelCache.h"
+#include "SmoothTasks/ShadowBlur.h"
+#include "SmoothTasks/WakeupMonitor.h"
 
 // Qt
 #include <QtGlobal>
@@ -62,7 +67,6 @@
 // Plasma
 #include <Plasma/FrameSvg>
 #include <Plasma/Theme>
-#include <Plasma/PaintUtils>
 
 #include <cmath>
 #include <cstring>
@@ -70,6 +74,7 @@
 namespace SmoothTasks {
 
 const qreal   TaskItem::MINIMIZED_TEXT_ALPHA  = 0.85;
+const int     TaskItem::LABEL_WIDTH_STEP      = 2;
 const QString TaskItem::GROUP_EXPANDER_TOP    = QString::fromLatin1("group-expander-top");
 const QString TaskItem::GROUP_EXPANDER_RIGHT  = QString::fromLatin1("group-expander-right");
 const QString TaskItem::GROUP_EXPANDER_LEFT   = QString::fromLatin1("group-expander-left");
@@ -84,20 +89,16 @@ TaskItem::TaskItem(AbstractGroupableItem *abstractItem, Applet *applet)
 		  m_light(new Light(this)),
 		  m_abstractItem(abstractItem),
 		  m_activateTimer(NULL),
-		  m_updateTimer(new QTimer()),
 		  m_mouseIn(false),
 		  m_delayedMouseIn(false),
 		  m_stateAnimation(),
+		  m_frameFade(),
 		  m_orientation(Qt::Horizontal),
-		  m_cellSize(0, 0),
-		  m_updateScheduled(false) {
+		  m_cellSize(0, 0) {
 	connect(applet, SIGNAL(settingsChanged()), this, SLOT(settingsChanged()));
 
 	m_icon->setIcon(m_task->icon());
 
-	m_updateTimer->setInterval(1000 / m_applet->fps());
-	connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(updateTimerTick()));
-
 	setAcceptsHoverEvents(true);
 	setAcceptDrops(true);
 
@@ -123,7 +124,9 @@ TaskItem::TaskItem(AbstractGroupableItem *abstractItem, Applet *applet)
 	
 	if (m_task->type() == Task::StartupItem) {
 		m_icon->startStartupAnimation(500);
-		m_light->startAnimation(Light::StartupAnimation, 500, true);
+		if (m_applet->lights()) {
+			m_light->startAnimation(Light::StartupAnimation, m_applet->fps(), 500, true);
+		}
 	}
 		
         if (abstractItem->itemType() == TaskManager::GroupItemType) {
@@ -143,7 +146,7 @@ TaskItem::TaskItem(AbstractGroupableItem *abstractItem, Applet *applet)
 
 TaskItem::~TaskItem() {
 	m_applet->toolTip()->itemDelete(this);
-	m_updateTimer->deleteLater();
+	m_applet->repaintScheduler()->cancel(this);
 	if (m_activateTimer) {
 		delete m_activateTimer;
 		m_activateTimer = NULL;
@@ -202,7 +205,13 @@ bool TaskItem::isExpanded() const {
 }
 
 void TaskItem::settingsChanged() {
-	m_updateTimer->setInterval(1000 / m_applet->fps());
+	if (!m_applet->lights()) {
+		m_light->stopAnimation();
+	}
+	else if (m_task->demandsAttention()) {
+		// joins the beat of the other items, so restarting does not show
+		m_light->startAnimation(Light::AttentionAnimation, m_applet->fps(), 900, true);
+	}
 	updateExpansion();
 }
 
@@ -215,24 +224,9 @@ void TaskItem::updateExpansion() {
 	}
 }
 
-void TaskItem::updateTimerTick() {
-	if (m_updateScheduled) {
-		QGraphicsWidget::update();
-		m_updateScheduled = false;
-	} else {
-		m_updateTimer->stop();
-	}
-}
-
+// repainted with the next frame, at most once per frame
 void TaskItem::update() {
-	// limit framerate to configured value
-	if (m_updateTimer->isActive()) {
-		m_updateScheduled = true;
-	}
-	else {
-		m_updateTimer->start();
-		QGraphicsWidget::update();
-	}
+	m_applet->repaintScheduler()->schedule(this);
 }
 
 void TaskItem::updateToolTip() {
@@ -413,7 +407,10 @@ void TaskItem::updateState() {
 
 	if (m_task->demandsAttention()) {
 		newState |= TaskStateAnimation::Attention;
-		m_light->startAnimation(Light::AttentionAnimation, 900, true);
+		// the light is not painted when disabled, so don't animate it
+		if (m_applet->lights()) {
+			m_light->startAnimation(Light::AttentionAnimation, m_applet->fps(), 900, true);
+		}
 	} 
 	else if (m_task->type() == Task::LauncherItem) {
 		newState |= TaskStateAnimation::Launcher;
@@ -667,6 +664,7 @@ void TaskItem::dragEnterEvent(QGraphicsSceneDragDropEvent *event) {
 			m_activateTimer->setSingleShot(true);
 			m_activateTimer->setInterval(DRAG_HOVER_DELAY);
 			connect(m_activateTimer, SIGNAL(timeout()), this, SLOT(activate()));
+			WakeupMonitor::self()->watch(m_activateTimer, "TaskItem::activate");
 		}
 		m_activateTimer->start();
 		hoverEnterEvent();
@@ -817,18 +815,15 @@ void TaskItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
 	p->setRenderHint(QPainter::Antialiasing);
 
 	// draw frame
-	// TODO: cache frame in TaskItem?
-	Plasma::FrameSvg *frame = m_applet->frame();
+	FrameRenderer *frame = m_applet->frameRenderer();
 	
 	qreal left = 0, top = 0, right = 0, bottom = 0;
-	frame->setElementPrefix(NORMAL);
-	frame->getMargins(left, top, right, bottom);
+	frame->getMargins(NORMAL, left, top, right, bottom);
 	
 	if (isVertical) {
 		if (m_applet->dontRotateFrame()) {
-			frame->resizeFrame(bounds.size());
 			if(showFrame) {
-				drawFrame(p, frame);
+				drawFrame(p, frame, bounds.size());
 			}
 			lightBounds.setHeight(bounds.width() - top - bottom);
 			lightBounds.setWidth(bounds.height() - left - right);
@@ -841,23 +836,23 @@ void TaskItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
 			p->translate(-bounds.height(), 0);
 		}
 		else {
+			// the frame comes turned from the renderer, only the light and
+			// the text are painted rotated
+			if(showFrame) {
+				drawFrame(p, frame, bounds.size(), Qt::Vertical);
+			}
 			p->save();
 			p->rotate(-90);
 			p->translate(-bounds.height(), 0);
 		
-			frame->resizeFrame(QSizeF(bounds.height(), bounds.width()));
-			if(showFrame) {
-				drawFrame(p, frame);
-			}
-			lightBounds = frame->contentsRect();
+			lightBounds = frame->contentsRect(NORMAL, QSizeF(bounds.height(), bounds.width()));
 		}
 	}
 	else {
-		frame->resizeFrame(bounds.size());
 		if(showFrame) {
-			drawFrame(p, frame);
+			drawFrame(p, frame, bounds.size());
 		}
-		lightBounds = frame->contentsRect();
+		lightBounds = frame->contentsRect(NORMAL, bounds.size());
 	}
 	
 	m_icon->setRect(bounds);
@@ -869,8 +864,12 @@ void TaskItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
 	if (m_applet->lights() && m_task->type() != Task::LauncherItem) {
 		bool mouseIn = false;
 		QPointF pos(mapFromGlobal(QCursor::pos(), &mouseIn));
+
+		if (isVertical) {
+			pos = QPointF(size().height() - pos.y(), pos.x());
+		}
 		
-		m_light->paint(p, lightBounds, pos, mouseIn, isVertical);
+		m_light->paint(p, lightBounds, pos, mouseIn, QColor(m_icon->highlightColor()));
 	}
 
 	// draw text
@@ -886,7 +885,7 @@ void TaskItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
 	m_icon->paint(p, m_stateAnimation.hover(), m_task->type() == Task::GroupItem);
 }
 
-void TaskItem::drawFrame(QPainter *p, Plasma::FrameSvg *frame) {
+void TaskItem::drawFrame(QPainter *p, FrameRenderer *frame, const QSizeF& size, Qt::Orientation orientation) {
 	// draw "layers":
 	//    hover
 	//    attention
@@ -897,14 +896,12 @@ void TaskItem::drawFrame(QPainter *p, Plasma::FrameSvg *frame) {
 	int reachedUpState = m_stateAnimation.reachedUpState();
 
 	if (animatedState) {
-		QPixmap pixmap;
-		bool didPaint   = false;
-		int  shownState = m_stateAnimation.shownState();
+		// the layers are faded into each other in one pass
+		const QSize imageSize(size.toSize());
+		int shownState = m_stateAnimation.shownState();
 		
 		if (!reachedUpState) {
-			frame->setElementPrefix(NORMAL);
-			pixmap   = frame->framePixmap();
-			didPaint = true;
+			m_frameFade.addLayer(frame->frameImage(NORMAL, imageSize, orientation));
 		}
 
 		if (shownState & TaskStateAnimation::Minimized &&
@@ -912,88 +909,47 @@ void TaskItem::drawFrame(QPainter *p, Plasma::FrameSvg *frame) {
 				TaskStateAnimation::Hover |
 				TaskStateAnimation::Attention |
 				TaskStateAnimation::Focus))) {
-			frame->setElementPrefix(MINIMIZED);
-
-			if (didPaint) {
-				pixmap = Plasma::PaintUtils::transition(
-					pixmap, frame->framePixmap(),
-					m_stateAnimation.minimized());
-			}
-			else {
-				pixmap   = frame->framePixmap();
-				didPaint = true;
-			}
+			m_frameFade.addLayer(frame->frameImage(MINIMIZED, imageSize, orientation), m_stateAnimation.minimized());
 		}
 
 		if (shownState & TaskStateAnimation::Focus &&
 				!(reachedUpState & (
 				TaskStateAnimation::Hover |
 				TaskStateAnimation::Attention))) {
-			frame->setElementPrefix(FOCUS);
-
-			if (didPaint) {
-				pixmap = Plasma::PaintUtils::transition(
-					pixmap, frame->framePixmap(),
-					m_stateAnimation.focus());
-			}
-			else {
-				pixmap   = frame->framePixmap();
-				didPaint = true;
-			}
+			m_frameFade.addLayer(frame->frameImage(FOCUS, imageSize, orientation), m_stateAnimation.focus());
 		}
 
 		if (shownState & TaskStateAnimation::Attention &&
 				!(reachedUpState & TaskStateAnimation::Hover)) {
-			frame->setElementPrefix(ATTENTION);
-
-			if (didPaint) {
-				pixmap = Plasma::PaintUtils::transition(
-					pixmap, frame->framePixmap(),
-					m_stateAnimation.attention());
-			}
-			else {
-				pixmap   = frame->framePixmap();
-				didPaint = true;
-			}
+			m_frameFade.addLayer(frame->frameImage(ATTENTION, imageSize, orientation), m_stateAnimation.attention());
 		}
 
 		if (shownState & TaskStateAnimation::Hover && !(m_applet->lights() && m_applet->onlyLights())) {
-			frame->setElementPrefix(HOVER);
-
-			if (didPaint) {
-				pixmap = Plasma::PaintUtils::transition(
-					pixmap, frame->framePixmap(),
-					m_stateAnimation.hover());
-			}
-			else {
-				pixmap   = frame->framePixmap();
-				didPaint = true;
-			}
+			m_frameFade.addLayer(frame->frameImage(HOVER, imageSize, orientation), m_stateAnimation.hover());
 		}
 
-		p->drawPixmap(QPoint(0, Plasma::TopMargin), pixmap);
+		p->drawImage(QPoint(0, Plasma::TopMargin), m_frameFade.render());
 	}
 	else {
+		const QString *prefix = &NORMAL;
+
 		if (reachedUpState & TaskStateAnimation::Hover && !(m_applet->lights() && m_applet->onlyLights())) {
-			frame->setElementPrefix(HOVER);
+			prefix = &HOVER;
 		}
 		else if (reachedUpState & TaskStateAnimation::Attention) {
-			frame->setElementPrefix(ATTENTION);
+			prefix = &ATTENTION;
 		}
 		else if (reachedUpState & TaskStateAnimation::Focus) {
-			frame->setElementPrefix(FOCUS);
+			prefix = &FOCUS;
 		}
 		else if (reachedUpState & TaskStateAnimation::Minimized) {
-			frame->setElementPrefix(MINIMIZED);
+			prefix = &MINIMIZED;
 		}
 // 		else if (reachedUpState & TaskStateAnimation::Launcher) {
-// 			frame->setElementPrefix(MINIMIZED);
+// 			prefix = &MINIMIZED;
 // 		}
-		else {
-			frame->setElementPrefix(NORMAL);
-		}
 
-		frame->paintFrame(p);
+		frame->paintFrame(p, *prefix, QRectF(QPointF(0, 0), size), orientation);
 	}
 }
 
@@ -1100,11 +1056,7 @@ void TaskItem::drawText(QPainter *p, qreal marginLeft, qreal marginTop, qreal ma
 	p->setPen(QPen(color, 1.0));
 
 	const bool rtl = QApplication::isRightToLeft();
-	QTextLayout layout(m_task->text(), KGlobalSettings::taskbarFont());
-
-	QTextOption textOption(layout.textOption());
-	textOption.setTextDirection(QApplication::layoutDirection());
-	layout.setTextOption(textOption);
+	const QFont font(KGlobalSettings::taskbarFont());
 
 	QRectF bounds(boundingRect());
 
@@ -1122,7 +1074,39 @@ void TaskItem::drawText(QPainter *p, qreal marginLeft, qreal marginTop, qreal ma
 		width  = bounds.width() - (m_cellSize.width() + 1) - marginRight;
 		height = m_cellSize.height() - marginTop - marginBottom;
 	}
+	// Quantized like the icon sizes, so the fractional widths of a layout
+	// without pixel snapping don't all miss the label cache.
+	width  = std::floor(width / LABEL_WIDTH_STEP) * LABEL_WIDTH_STEP;
+	height = std::floor(height);
+
+	const QPointF origin(x, y);
 	QRectF textRect(x, y, width, height);
+
+	// everything the label is rendered from
+	LabelCache::Key key;
+	key.text       = m_task->text();
+	key.font       = font.key();
+	key.size       = QSize(int(width), int(height));
+	key.color      = color.rgba();
+	key.shadow     = m_applet->textShadow();
+	key.direction  = QApplication::layoutDirection();
+	key.groupCount = m_task->type() == Task::GroupItem ? m_task->taskCount() : 0;
+	key.expander   = expanderElement();
+
+	LabelCache *cache = m_applet->labelCache();
+	const LabelCache::Label *cached = cache->find(key);
+
+	if (cached) {
+		cached->paint(p, origin);
+		return;
+	}
+
+	QTextLayout layout(key.text, font);
+
+	QTextOption textOption(layout.textOption());
+	textOption.setTextDirection(key.direction);
+	layout.setTextOption(textOption);
+
 	QSizeF textSize(::SmoothTasks::layoutText(layout, textRect.size()));
 
 	// Hack for plamsa layouts that define a to large margin:
@@ -1138,22 +1122,34 @@ void TaskItem::drawText(QPainter *p, qreal marginLeft, qreal marginTop, qreal ma
 		textRect.setHeight(hackTextSize);
 	}
 
-	drawTextLayout(p, layout, textRect, textSize, color);
+	LabelCache::Label label(renderLabel(layout, textRect, textSize, color));
+	label.position -= origin;
+
+	// the sizes an expansion passes through won't be seen again, they would
+	// only push the labels out of the cache that will be
+	if (!m_applet->taskbarLayout()->isResizing(this)) {
+		cache->insert(key, label);
+	}
+	label.paint(p, origin);
 }
 
-void TaskItem::drawTextLayout(QPainter *painter,
+LabelCache::Label TaskItem::renderLabel(
 		const QTextLayout& layout,
 		const QRectF&      rect,
 		const QSizeF&      textSize,
 		const QColor&      color) const {
+	LabelCache::Label label;
+	label.position = rect.topLeft();
+
 	if (rect.width() < 1 || rect.height() < 1) {
-		return;
+		return label;
 	}
-	QPixmap pixmap(std::ceil(rect.width()), std::ceil(rect.height()));
-	pixmap.fill(Qt::transparent);
+	// rendered on the client side, the shadow needs the pixels anyway
+	QImage image(std::ceil(rect.width()), std::ceil(rect.height()), QImage::Format_ARGB32_Premultiplied);
+	image.fill(0);
 
-	QPainter p(&pixmap);
-	p.setPen(painter->pen());
+	QPainter p(&image);
+	p.setPen(QPen(color, 1.0));
 
 	// expander measures:
 	QRectF expRect(expanderRect(QRectF(QPointF(0, 0), rect.size())));
@@ -1212,12 +1208,12 @@ void TaskItem::drawTextLayout(QPainter *painter,
 		}
 		if (!expRect.isEmpty()) {
 			if (rtl) {
-				p.fillRect(0, 0, (int) expRect.width(), pixmap.height(), Qt::transparent);
+				p.fillRect(0, 0, (int) expRect.width(), image.height(), Qt::transparent);
 			}
 			else {
 				p.fillRect((int) expRect.left(), 0,
-					pixmap.width() - (int) expRect.left(),
-					pixmap.height(), Qt::transparent);
+					image.width() - (int) expRect.left(),
+					image.height(), Qt::transparent);
 			}
 		}
 		p.setCompositionMode(QPainter::CompositionMode_SourceOver);
@@ -1226,11 +1222,13 @@ void TaskItem::drawTextLayout(QPainter *painter,
 	p.end();
 	
 	if (m_applet->textShadow()) {
-		QImage shadow(pixmap.toImage());
-		Plasma::PaintUtils::shadowBlur(shadow, 2, (color.value() < 128 ? Qt::white : Qt::black));
-		painter->drawImage(rect.topLeft() + QPointF(1, 2), shadow);
+		QImage shadow(image);
+		ShadowBlur::apply(shadow, 2, (color.value() < 128 ? Qt::white : Qt::black));
+		label.shadow = imageToPixmap(shadow);
 	}
-	painter->drawPixmap(rect.topLeft(), pixmap);
+	label.pixmap = imageToPixmap(image);
+
+	return label;
 }
 
 /** initially copied from KDEs Task plasmoid but substantially altered */
@@ -24,6 +24,8 @@
 // Smooth Tasks
 #include "SmoothTasks/Task.h"
 #include "SmoothTasks/TaskStateAnimation.h"
+#include "SmoothTasks/CrossFade.h"
+#include "SmoothTasks/LabelCache.h"
 #include "SmoothTasks/ExpansionDirection.h"
 
 // Qt
@@ -63,6 +65,7 @@ class TaskbarLayout;
 class Light;
 class TaskIcon;
 class Applet;
+class FrameRenderer;
 
 class TaskItem : public QGraphicsWidget {
     Q_OBJECT
@@ -98,12 +101,12 @@ public slots:
 	void confirmEnter();
 
 private slots:
-	void updateTimerTick();
 	void updateToolTip();
 	void publishIconGeometry();
 
 private:
 	static const qreal MINIMIZED_TEXT_ALPHA;
+	static const int   LABEL_WIDTH_STEP;
 
 	// "string table"
 	static const QString GROUP_EXPANDER_TOP;
@@ -114,7 +117,8 @@ private:
 	void           updateExpansion();
 	void           activateOrIconifyGroup();
 	void           drawText(QPainter *p, qreal marginLeft, qreal marginTop, qreal marginRight, qreal marginBottom);
-	void           drawFrame(QPainter *p, Plasma::FrameSvg *frame);
+	void           drawFrame(QPainter *p, FrameRenderer *frame, const QSizeF& size,
+		Qt::Orientation orientation = Qt::Horizontal);
 	void           expandTask();
 	void           collapseTask();
 	void           collapseTaskOnLeave();
@@ -132,15 +136,13 @@ private:
 	TaskManager::AbstractGroupableItem *m_abstractItem;
 
 	QTimer            *m_activateTimer;
-	QTimer            *m_updateTimer;
 	bool               m_mouseIn;
 	bool               m_delayedMouseIn;
 	TaskStateAnimation m_stateAnimation;
+	CrossFade          m_frameFade;
 
 	Qt::Orientation m_orientation;
 	QSizeF          m_cellSize;
-	
-	bool m_updateScheduled;
 
 protected:
 	void dropEvent(QGraphicsSceneDragDropEvent *event);
@@ -161,9 +163,9 @@ protected:
 private:
 	void hoverEnterEvent();
 	void hoverLeaveEvent();
-	void drawTextLayout(
-		QPainter *painter, const QTextLayout& layout,
-		const QRectF& rect, const QSizeF& textSize, const QColor& color) const;
+	LabelCache::Label renderLabel(
+		const QTextLayout& layout, const QRectF& rect,
+		const QSizeF& textSize, const QColor& color) const;
 
 signals:
 	void itemActive(TaskItem* item);
@@ -1,6 +1,6 @@
 #include "SmoothTasks/TaskStateAnimation.h"
 
-#include <Plasma/Animator>
+#include "SmoothTasks/AnimationDriver.h"
 
 namespace SmoothTasks {
 
@@ -14,14 +14,11 @@ TaskStateAnimation::TaskStateAnimation()
 	  m_attention(0.0),
 	  m_focus(0.0),
 	  m_lastProgress(0.0) {
-	connect(
-		Plasma::Animator::self(), SIGNAL(customAnimationFinished(int)),
-		this, SLOT(animationFinished(int)));
 }
 
 void TaskStateAnimation::stop() {
 	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
+		AnimationDriver::self()->stop(m_animation);
 		m_animation = 0;
 	}
 }
@@ -35,10 +32,8 @@ void TaskStateAnimation::start(int fps, int duration) {
 		animationFinished(m_animation);
 	}
 	else {
-		m_animation = Plasma::Animator::self()->customAnimation(
-			frames, duration,
-			Plasma::Animator::LinearCurve,
-			this, "animate");
+		m_animation = AnimationDriver::self()->start(
+			duration, fps, this, "animate", "animationFinished");
 	}
 }
 
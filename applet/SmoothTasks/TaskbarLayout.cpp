@@ -21,30 +21,49 @@
 #include <QApplication>
 #include <QGraphicsItem>
 #include <QDebug>
-#include <QTime>
+#include <QDrag>
 
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
-#include <Plasma/Animator>
-
 #include "SmoothTasks/TaskbarLayout.h"
+#include "SmoothTasks/AnimationDriver.h"
 #include "SmoothTasks/TaskItem.h"
 
 namespace SmoothTasks {
 
-const QTime TaskbarLayout::Midnight(0, 0, 0, 0);
+namespace {
 
-TaskbarItem::~TaskbarItem() {
-	if (item) {
-		item->setParentLayoutItem(NULL);
-		if (item->ownedByLayout()) {
-			delete item;
-		}
+// like QList::move() for the parallel item state vectors
+template<typename T>
+inline void moveElement(QVector<T>& vector, int from, int to) {
+	T *data = vector.data();
+
+	if (from < to) {
+		std::rotate(data + from, data + from + 1, data + to + 1);
+	}
+	else if (from > to) {
+		std::rotate(data + to, data + from, data + from + 1);
 	}
 }
 
+// whether pos is on item or in the spacing around it
+inline bool hits(TaskItem *item, const QPointF& pos, qreal halfSpacing) {
+	QRectF rect = item->geometry();
+	qreal y = rect.y();
+	qreal x = rect.x();
+
+	return
+		pos.y() >= (y - halfSpacing) && pos.y() < (y + rect.height() + halfSpacing) &&
+		pos.x() >= (x - halfSpacing) && pos.x() < (x + rect.width()  + halfSpacing);
+}
+
+} // anonymous namespace
+
 const qreal TaskbarLayout::PIXELS_PER_SECOND = 500;
+// differences below this many pixels are not visible
+const qreal TaskbarLayout::GEOMETRY_TOLERANCE = 0.01;
 
 TaskbarLayout::TaskbarLayout(Qt::Orientation orientation, QGraphicsLayoutItem *parent)
 	: QGraphicsLayout(parent),
@@ -52,9 +71,16 @@ TaskbarLayout::TaskbarLayout(Qt::Orientation orientation, QGraphicsLayoutItem *p
 	  m_currentIndex(-1),
 	  m_currentAnimation(None),
 	  m_mouseIn(false),
+	  m_draggedItemEnabled(true),
+	  m_indices(),
+	  m_validIndices(0),
+	  m_expandedCount(0),
+	  m_hoverExpandedCount(0),
+	  m_persistentPrefix(),
+	  m_persistentPrefixValid(false),
 	  m_orientation(orientation),
 	  m_spacing(0.0),
-	  m_animationTimer(new QTimer(this)),
+	  m_animationTrack(0),
 	  m_grabPos(),
 	  m_fps(35),
 	  m_animationsEnabled(true),
@@ -63,13 +89,31 @@ TaskbarLayout::TaskbarLayout(Qt::Orientation orientation, QGraphicsLayoutItem *p
 	  m_expandedWidth(175),
 	  m_aspectRatio(1.0),
 	  m_expandDuration(160),
+	  m_monotonicClock(),
+	  m_animationClock(&m_monotonicClock),
 	  m_timeStamp(0),
+	  m_stableSizeHint(false),
+	  m_reportedPreferredSize(0.0, 0.0),
+	  m_pixelSnapping(false),
+	  m_geometryUpdates(0),
+	  m_skippedGeometryUpdates(0),
+	  m_dirtyBegin(0),
+	  m_dirtyEnd(std::numeric_limits<int>::max()),
+	  m_batchDepth(0),
+	  m_batchInvalidated(false),
+	  m_rowInfos(),
+	  m_rowInfoCount(0),
+	  m_newRowInfos(),
+	  m_newRowInfoCount(0),
+	  m_layoutRows(0),
+	  m_layoutCellWidth(0.0),
+	  m_layoutCellHeight(0.0),
+	  m_layoutAvailableWidth(0.0),
+	  m_layoutRect(),
+	  m_layoutRtl(false),
 	  m_preferredSize(0.0, 0.0),
 	  m_cellHeight(1.0),
 	  m_rows(1) {
-	m_animationTimer->setInterval(1000 / m_fps);
-
-	connect(m_animationTimer, SIGNAL(timeout()), this, SLOT(animate()));
 }
 
 // more or less copied from QGraphicsLinearLayout
@@ -80,8 +124,8 @@ TaskbarLayout::~TaskbarLayout() {
 void TaskbarLayout::setOrientation(Qt::Orientation orientation) {
 	if (orientation != m_orientation) {
 		m_orientation = orientation;
-		foreach (TaskbarItem *item, m_items) {
-			item->item->setOrientation(orientation);
+		foreach (TaskItem *item, m_items) {
+			item->setOrientation(orientation);
 		}
 		stopAnimation();
 		invalidate();
@@ -106,10 +150,7 @@ void TaskbarLayout::setFps(int fps) {
 		return;
 	}
 
-	if (m_fps != fps) {
-		m_fps = fps;
-		m_animationTimer->setInterval(1000 / m_fps);
-	}
+	m_fps = fps;
 }
 
 void TaskbarLayout::setAnimationsEnabled(bool animationsEnabled) {
@@ -120,6 +161,105 @@ void TaskbarLayout::setAnimationsEnabled(bool animationsEnabled) {
 	}
 }
 
+void TaskbarLayout::setStableSizeHint(bool stableSizeHint) {
+	if (m_stableSizeHint != stableSizeHint) {
+		m_stableSizeHint = stableSizeHint;
+		reportPreferredSize();
+	}
+}
+
+void TaskbarLayout::setPixelSnapping(bool pixelSnapping) {
+	if (m_pixelSnapping != pixelSnapping) {
+		m_pixelSnapping = pixelSnapping;
+		invalidate();
+	}
+}
+
+void TaskbarLayout::setAnimationClock(AnimationClock *clock) {
+	m_animationClock = clock ? clock : &m_monotonicClock;
+	m_timeStamp      = m_animationClock->now();
+}
+
+void TaskbarLayout::resetGeometryCounters() {
+	m_geometryUpdates        = 0;
+	m_skippedGeometryUpdates = 0;
+}
+
+// Setting the geometry of a QGraphicsWidget is not free even if it does not
+// change, and TaskItem repositions its icon whenever it is called.
+void TaskbarLayout::setItemGeometry(TaskItem *item, const QRectF& rect) {
+	const QRectF current(item->geometry());
+
+	if (qAbs(current.x()      - rect.x())      <= GEOMETRY_TOLERANCE &&
+			qAbs(current.y()      - rect.y())      <= GEOMETRY_TOLERANCE &&
+			qAbs(current.width()  - rect.width())  <= GEOMETRY_TOLERANCE &&
+			qAbs(current.height() - rect.height()) <= GEOMETRY_TOLERANCE) {
+		++ m_skippedGeometryUpdates;
+		return;
+	}
+
+	++ m_geometryUpdates;
+	item->setGeometry(rect);
+}
+
+void TaskbarLayout::setPreferredSize(const QSizeF& preferredSize) {
+	m_preferredSize = preferredSize;
+	reportPreferredSize();
+}
+
+void TaskbarLayout::reportPreferredSize() {
+	if (!m_stableSizeHint || !m_animationsEnabled) {
+		reportPreferredSize(m_preferredSize);
+	}
+	// While stable the target size was reported when the animation started.
+	// Once it is finished only an estimate that was off is corrected.
+	else if (!(m_currentAnimation & Resize) && (
+			qAbs(m_reportedPreferredSize.width()  - m_preferredSize.width())  > GEOMETRY_TOLERANCE ||
+			qAbs(m_reportedPreferredSize.height() - m_preferredSize.height()) > GEOMETRY_TOLERANCE)) {
+		reportPreferredSize(m_preferredSize);
+	}
+}
+
+void TaskbarLayout::reportPreferredSize(const QSizeF& preferredSize) {
+	if (m_reportedPreferredSize != preferredSize) {
+		m_reportedPreferredSize = preferredSize;
+		emit sizeHintChanged(Qt::PreferredSize);
+	}
+}
+
+// Estimates the preferred size once all expand and collapse animations are
+// finished, assuming the items stay in their rows.
+QSizeF TaskbarLayout::targetPreferredSize() const {
+	const int N = m_items.size();
+	qreal currentWidth = 0.0;
+	qreal targetWidth  = 0.0;
+
+	for (int row = 0; row < m_rowInfoCount; ++ row) {
+		const RowInfo& rowInfo = m_rowInfos[row];
+		const int      end     = qMin(rowInfo.endIndex, N);
+		const qreal    width   = rowInfo.preferredWidth + rowInfo.preferredSpacing;
+		qreal          change  = 0.0;
+
+		for (int index = rowInfo.startIndex; index < end; ++ index) {
+			change += (m_direction[index] == Expand ? m_expandedWidth : 0.0) - m_expansion[index];
+		}
+
+		currentWidth = qMax(currentWidth, width);
+		targetWidth  = qMax(targetWidth,  width + change);
+	}
+
+	QSizeF size(m_preferredSize);
+
+	if (m_orientation == Qt::Vertical) {
+		size.rheight() += targetWidth - currentWidth;
+	}
+	else {
+		size.rwidth() += targetWidth - currentWidth;
+	}
+
+	return size;
+}
+
 void TaskbarLayout::setMaximumRows(int maximumRows) {
 	if (maximumRows < 1) {
 		qWarning("TaskbarLayout::setMaximumRows: invalid maximumRows %d", maximumRows);
@@ -218,7 +358,7 @@ QSizeF TaskbarLayout::sizeHint(Qt::SizeHint which, const QSizeF& constraint) con
 	case Qt::MinimumSize:
 		return QSizeF(0.0, 0.0);
 	case Qt::PreferredSize:
-		return m_preferredSize;
+		return m_reportedPreferredSize;
 	case Qt::MaximumSize:
 		return QSizeF(std::numeric_limits<qreal>::max(), std::numeric_limits<qreal>::max());
 	case Qt::MinimumDescent:
@@ -235,6 +375,69 @@ void TaskbarLayout::setGeometry(const QRectF& rect) {
 	doLayout();
 }
 
+void TaskbarLayout::invalidate() {
+	markDirty(0, std::numeric_limits<int>::max());
+
+	if (isBatching()) {
+		m_batchInvalidated = true;
+	}
+	else {
+		QGraphicsLayout::invalidate();
+	}
+}
+
+// Like invalidate(), but only the items in [begin, end) changed (were
+// inserted, removed, moved or changed their expansion). The next layout pass
+// then only touches the rows containing these items.
+void TaskbarLayout::invalidateRange(int begin, int end) {
+	if (begin < 0 || begin > end) {
+		qWarning("TaskbarLayout::invalidateRange: invalid range %d - %d", begin, end);
+		return;
+	}
+
+	markDirty(begin, end);
+
+	if (isBatching()) {
+		m_batchInvalidated = true;
+	}
+	else {
+		QGraphicsLayout::invalidate();
+	}
+}
+
+// Between beginBatch() and commitBatch() items can be inserted, moved and
+// removed without invalidating the layout each time. The changes are
+// collected and the layout is invalidated once when the outermost batch is
+// committed. Batches can be nested.
+void TaskbarLayout::beginBatch() {
+	++ m_batchDepth;
+}
+
+void TaskbarLayout::commitBatch() {
+	if (m_batchDepth <= 0) {
+		qWarning("TaskbarLayout::commitBatch: no batch to commit");
+		return;
+	}
+
+	-- m_batchDepth;
+
+	if (m_batchDepth == 0 && m_batchInvalidated) {
+		m_batchInvalidated = false;
+		QGraphicsLayout::invalidate();
+	}
+}
+
+void TaskbarLayout::markDirty(int begin, int end) {
+	if (m_dirtyBegin >= m_dirtyEnd) {
+		m_dirtyBegin = begin;
+		m_dirtyEnd   = end;
+	}
+	else {
+		m_dirtyBegin = qMin(m_dirtyBegin, begin);
+		m_dirtyEnd   = qMax(m_dirtyEnd,   end);
+	}
+}
+
 QRectF TaskbarLayout::effectiveGeometry() const {
 	QRectF effectiveRect(geometry());
 	qreal left = 0, top = 0, right = 0, bottom = 0;
@@ -253,7 +456,14 @@ QRectF TaskbarLayout::effectiveGeometry() const {
 	return effectiveRect;
 }
 
-void TaskbarLayout::buildRows(const int itemsPerRow, const qreal cellWidth, QList<RowInfo>& rowInfos, int& rows, qreal& maxPreferredRowWidth) const {
+void TaskbarLayout::appendRow(const RowInfo& rowInfo) {
+	if (m_newRowInfoCount == m_newRowInfos.size()) {
+		m_newRowInfos.resize(qMax(8, m_newRowInfos.size() * 2));
+	}
+	m_newRowInfos[m_newRowInfoCount ++] = rowInfo;
+}
+
+void TaskbarLayout::buildRows(const int itemsPerRow, const qreal cellWidth, int& rows, qreal& maxPreferredRowWidth) {
 	const int N = m_items.size();
 	const qreal spacing = m_spacing;
 	maxPreferredRowWidth = 0;
@@ -267,6 +477,11 @@ void TaskbarLayout::buildRows(const int itemsPerRow, const qreal cellWidth, QLis
 	int startIndex = 0;
 	int endIndex   = 0;
 
+	clearRows();
+
+	// rows that still hold the same clean items don't have to be summed up again
+	const bool reuseRows = cellWidth == m_layoutCellWidth;
+
 	for (int row = 0; row < rows && endIndex < N; ++ row) {
 		startIndex = endIndex;
 
@@ -281,32 +496,107 @@ void TaskbarLayout::buildRows(const int itemsPerRow, const qreal cellWidth, QLis
 		qreal thisRowWidth    = 0.0;
 		qreal thisRowMinWidth = 0.0;
 
-		for (int index = startIndex; index < endIndex; ++ index) {
-			thisRowWidth    += cellWidth + m_items[index]->expansion;
-			thisRowMinWidth += cellWidth;
+		if (reuseRows && row < m_rowInfoCount && !isDirty(startIndex, endIndex) &&
+				m_rowInfos[row].startIndex == startIndex &&
+				m_rowInfos[row].endIndex   == endIndex) {
+			thisRowWidth    = m_rowInfos[row].preferredWidth;
+			thisRowMinWidth = m_rowInfos[row].minimumWidth;
+		}
+		else {
+			for (int index = startIndex; index < endIndex; ++ index) {
+				thisRowWidth    += cellWidth + m_expansion[index];
+				thisRowMinWidth += cellWidth;
+			}
 		}
 
 		if (thisRowWidth + rowSpacing > maxPreferredRowWidth) {
 			maxPreferredRowWidth = thisRowWidth + rowSpacing;
 		}
-		rowInfos.append(RowInfo(thisRowWidth, thisRowMinWidth, startIndex, endIndex));
+		appendRow(RowInfo(thisRowWidth, thisRowMinWidth, startIndex, endIndex, rowSpacing));
 	}
 
 	// if we assumed expanded there still might be empty row
 	// therefore just scale up the layout (maybe do only this and not the other way of row removal)
-	rows = qMax(m_minimumRows, rowInfos.size());
+	rows = qMax(m_minimumRows, m_newRowInfoCount);
+}
+
+// Lays out the items [firstIndex, endIndex) of a row starting at pos and
+// returns the position after the last item. Orientation and direction are
+// template parameters, so each variant is compiled without branching on them
+// per item.
+template<bool Vertical, bool Rtl>
+qreal TaskbarLayout::layoutRow(
+		const int row, const int firstIndex, const int endIndex,
+		qreal pos, const qreal rowOffset,
+		const qreal cellWidth, const qreal cellHeight,
+		const qreal scale, const qreal scaleExp,
+		const QRectF& effectiveRect, const bool animateMove) {
+	const TaskItem *draggedItem = m_draggedItem;
+	const qreal    *expansion   = m_expansion.constData();
+	qreal          *destX       = m_destX.data();
+	qreal          *destY       = m_destY.data();
+	qreal          *offset      = m_offset.data();
+	const qreal     spacing     = m_spacing;
+	const qreal     rowStart    = Vertical ? effectiveRect.top()    : effectiveRect.left();
+	const qreal     rowEnd      = Vertical ? effectiveRect.bottom() : effectiveRect.right();
+	const bool      snap        = m_pixelSnapping;
+	const qreal     across      = snap ? std::floor(rowOffset + 0.5) : rowOffset;
+	QRectF rect(effectiveRect.left(), effectiveRect.top(), cellHeight, cellHeight);
+
+	for (int index = firstIndex; index < endIndex; ++ index) {
+		TaskItem *item = m_items[index];
+		const qreal width = (cellWidth + expansion[index] * scaleExp) * scale;
+		qreal along = Rtl ? rowEnd - (pos - rowStart) - width : pos;
+		qreal size  = width;
+
+		if (snap) {
+			// snap both ends so neighbouring items still line up
+			const qreal end = std::floor(along + width + 0.5);
+			along = std::floor(along + 0.5);
+			size  = end - along;
+		}
+
+		m_row[index]  = row;
+		offset[index] = pos - rowStart;
+		if (Vertical) {
+			rect.setHeight(size);
+
+			destX[index] = across;
+			destY[index] = along;
+		}
+		else {
+			rect.setWidth(size);
+
+			destX[index] = along;
+			destY[index] = across;
+		}
+
+		if ((!animateMove || m_isNew[index]) && item != draggedItem) {
+			m_isNew[index] = false;
+			rect.moveLeft(destX[index]);
+			rect.moveTop(destY[index]);
+		}
+		else {
+			m_animation[index] |= Move;
+			rect.moveTopLeft(item->geometry().topLeft());
+		}
+
+		setItemGeometry(item, rect);
+		pos += width + spacing;
+	}
+
+	return pos;
 }
 
 void TaskbarLayout::updateLayout(
 		const int rows, const qreal cellWidth, const qreal cellHeight,
 		const qreal availableWidth, const qreal maxPreferredRowWidth,
-		const QList<RowInfo>& rowInfos, const QRectF& effectiveRect) {
+		const QRectF& effectiveRect) {
 	// before updating the geometries of the items set the properties
 	// that might get read by the items in their event handlers:
 	const bool  isVertical  = m_orientation == Qt::Vertical;
 	const qreal spacing     = m_spacing;
 	const bool  animateMove = m_currentAnimation & Move;
-	const QSizeF oldPreferredSize(m_preferredSize);
 
 	m_rows = rows;
 
@@ -314,107 +604,222 @@ void TaskbarLayout::updateLayout(
 		const QSizeF cellSize(cellHeight * m_aspectRatio, cellHeight);
 		m_cellHeight = cellHeight;
 
-		foreach (TaskbarItem *item, m_items) {
-			item->item->setCellSize(cellSize);
+		foreach (TaskItem *item, m_items) {
+			item->setCellSize(cellSize);
 		}
 	}
 
-	qreal left = 0, top = 0, right = 0, bottom = 0;
-	getContentsMargins(&left, &top, &right, &bottom);
-
-	if (isVertical) {
-		m_preferredSize.setWidth(geometry().width());
-		m_preferredSize.setHeight(top + maxPreferredRowWidth + bottom);
-	}
-	else {
-		m_preferredSize.setWidth(left + maxPreferredRowWidth + right);
-		m_preferredSize.setHeight(geometry().height());
-	}
+	updatePreferredSize(maxPreferredRowWidth);
 
 	// now do the actual layouting:
 	const bool rtl = QApplication::isRightToLeft();
 	qreal rowOffset = isVertical ?
 		effectiveRect.left() :
 		effectiveRect.top();
-	QRectF rect(effectiveRect.left(), effectiveRect.top(), cellHeight, cellHeight);
-	const TaskbarItem *draggedItem = m_draggedItem;
-
-	for (int row = 0; row < rowInfos.size(); ++ row) {
-		const RowInfo& rowInfo = rowInfos[row];
-
-		qreal pos = isVertical ?
+	const qreal *expansion = m_expansion.constData();
+	const qreal *offset    = m_offset.constData();
+	const RowKernel layoutRow  = rowKernel(isVertical, rtl);
+
+	// If nothing global changed, rows that keep their items and scaling and
+	// contain no dirty item are already layed out. Dirty rows only need to be
+	// updated starting at the first dirty item.
+	const bool relayoutAll =
+		rows           != m_layoutRows           ||
+		cellWidth      != m_layoutCellWidth      ||
+		cellHeight     != m_layoutCellHeight     ||
+		availableWidth != m_layoutAvailableWidth ||
+		effectiveRect  != m_layoutRect           ||
+		rtl            != m_layoutRtl;
+	const RowInfo *oldRowInfos = m_rowInfos.constData();
+	RowInfo       *rowInfos    = m_newRowInfos.data();
+
+	for (int row = 0; row < m_newRowInfoCount; ++ row) {
+		RowInfo& rowInfo = rowInfos[row];
+
+		const qreal rowStart = isVertical ?
 			effectiveRect.top() :
 			effectiveRect.left();
+		qreal pos = rowStart;
 
-		qreal rowSpacings = (rowInfo.endIndex - rowInfo.startIndex) * spacing;
-		qreal scale       = 1.0;
-		qreal scaleExp    = 0.0;
+		scaleRow(rowInfo, availableWidth);
 
-		// scale item lengths down if necesarry:
-		if (rowInfo.preferredWidth + rowSpacings <= availableWidth) {
-			scaleExp = 1.0;
-		}
-		else {
-			qreal availableExpWidth = availableWidth - rowSpacings - rowInfo.minimumWidth;
-			qreal preferredExpWidth = rowInfo.preferredWidth - rowInfo.minimumWidth;
+		const qreal scale    = rowInfo.scale;
+		const qreal scaleExp = rowInfo.scaleExp;
 
-			if (rowInfo.minimumWidth + rowSpacings <= availableWidth && preferredExpWidth > 0.0 && availableExpWidth > 0.0) {
-				scaleExp = availableExpWidth / preferredExpWidth;
-			}
-			else if (availableWidth > rowSpacings && rowInfo.minimumWidth > 0.0) {
-				scale = (availableWidth - rowSpacings) / rowInfo.minimumWidth;
-			}
-			else {
-				scale = 0.0;
-			}
-		}
-		
-		for (int index = rowInfo.startIndex; index < rowInfo.endIndex; ++ index) {
-			TaskbarItem *item = m_items[index];
-			qreal width = (cellWidth + item->expansion * scaleExp) * scale;
-
-			item->row = row;
-			if (isVertical) {
-				rect.setHeight(width);
-
-				item->destX = rowOffset;
-				item->destY = rtl ?
-					effectiveRect.bottom() - (pos - effectiveRect.top()) - width :
-					pos;
-			}
-			else {
-				rect.setWidth(width);
+		int firstIndex = rowInfo.startIndex;
 
-				item->destX = rtl ?
-					effectiveRect.right() - (pos - effectiveRect.left()) - width :
-					pos;
-				item->destY = rowOffset;
-			}
+		if (!relayoutAll && row < m_rowInfoCount) {
+			const RowInfo& oldRowInfo = oldRowInfos[row];
 
-			if ((!animateMove || item->isNew) && item != draggedItem) {
-				item->isNew = false;
-				rect.moveLeft(item->destX);
-				rect.moveTop(item->destY);
-			}
-			else {
-				item->animation |= Move;
-				rect.moveTopLeft(item->item->geometry().topLeft());
+			if (oldRowInfo.startIndex == rowInfo.startIndex &&
+					oldRowInfo.endIndex == rowInfo.endIndex &&
+					oldRowInfo.scale    == scale &&
+					oldRowInfo.scaleExp == scaleExp) {
+				if (!isDirty(rowInfo.startIndex, rowInfo.endIndex)) {
+					rowInfo.length = oldRowInfo.length;
+					rowOffset += cellHeight + spacing;
+					continue;
+				}
+				firstIndex = qMax(rowInfo.startIndex, m_dirtyBegin);
 			}
+		}
 
-			item->item->setGeometry(rect);
-			pos += width + spacing;
+		// skip the clean items at the start of the row
+		if (firstIndex > rowInfo.startIndex) {
+			const int last = firstIndex - 1;
+			pos += offset[last] + (cellWidth + expansion[last] * scaleExp) * scale + spacing;
 		}
 
+		pos = (this->*layoutRow)(
+			row, firstIndex, rowInfo.endIndex, pos, rowOffset,
+			cellWidth, cellHeight, scale, scaleExp, effectiveRect, animateMove);
+
+		rowInfo.length = pos - rowStart;
 		rowOffset += cellHeight + spacing;
 	}
 
+	m_layoutRows           = rows;
+	m_layoutCellWidth      = cellWidth;
+	m_layoutCellHeight     = cellHeight;
+	m_layoutAvailableWidth = availableWidth;
+	m_layoutRect           = effectiveRect;
+	m_layoutRtl            = rtl;
+	m_dirtyBegin           = 0;
+	m_dirtyEnd             = 0;
+
+	// the rows of this pass become the rows of the last pass
+	qSwap(m_rowInfos,     m_newRowInfos);
+	qSwap(m_rowInfoCount, m_newRowInfoCount);
+	m_newRowInfoCount = 0;
+
 	if (m_currentAnimation != None) {
 		startAnimation();
 	}
 
-	if (oldPreferredSize != m_preferredSize) {
-		emit sizeHintChanged(Qt::PreferredSize);
+	reportPreferredSize();
+}
+
+TaskbarLayout::RowKernel TaskbarLayout::rowKernel(bool isVertical, bool rtl) const {
+	return isVertical ?
+		(rtl ? &TaskbarLayout::layoutRow<true,  true> : &TaskbarLayout::layoutRow<true,  false>) :
+		(rtl ? &TaskbarLayout::layoutRow<false, true> : &TaskbarLayout::layoutRow<false, false>);
+}
+
+// scale item lengths down if necesarry
+void TaskbarLayout::scaleRow(RowInfo& rowInfo, qreal availableWidth) const {
+	const qreal rowSpacings = (rowInfo.endIndex - rowInfo.startIndex) * m_spacing;
+	qreal scale    = 1.0;
+	qreal scaleExp = 0.0;
+
+	if (rowInfo.preferredWidth + rowSpacings <= availableWidth) {
+		scaleExp = 1.0;
+	}
+	else {
+		qreal availableExpWidth = availableWidth - rowSpacings - rowInfo.minimumWidth;
+		qreal preferredExpWidth = rowInfo.preferredWidth - rowInfo.minimumWidth;
+
+		if (rowInfo.minimumWidth + rowSpacings <= availableWidth && preferredExpWidth > 0.0 && availableExpWidth > 0.0) {
+			scaleExp = availableExpWidth / preferredExpWidth;
+		}
+		else if (availableWidth > rowSpacings && rowInfo.minimumWidth > 0.0) {
+			scale = (availableWidth - rowSpacings) / rowInfo.minimumWidth;
+		}
+		else {
+			scale = 0.0;
+		}
+	}
+
+	rowInfo.scale    = scale;
+	rowInfo.scaleExp = scaleExp;
+}
+
+void TaskbarLayout::updatePreferredSize(qreal maxPreferredRowWidth) {
+	qreal left = 0, top = 0, right = 0, bottom = 0;
+	getContentsMargins(&left, &top, &right, &bottom);
+
+	if (m_orientation == Qt::Vertical) {
+		m_preferredSize.setWidth(geometry().width());
+		m_preferredSize.setHeight(top + maxPreferredRowWidth + bottom);
+	}
+	else {
+		m_preferredSize.setWidth(left + maxPreferredRowWidth + right);
+		m_preferredSize.setHeight(geometry().height());
+	}
+}
+
+// Updates the rows containing the items in [begin, end) after only the
+// expansions of these items changed, e.g. during an expand or collapse
+// animation. The items stay in their rows, so only the followers of the
+// changed items in the same rows are moved and no full layout pass is
+// needed. Returns false if the layout is pending anyway or there is no
+// previous pass to start from.
+bool TaskbarLayout::updateRows(int begin, int end) {
+	if (isBatching() || m_dirtyBegin < m_dirtyEnd || m_rowInfoCount == 0) {
+		return false;
+	}
+
+	const int N = m_items.size();
+
+	if (m_rowInfos[m_rowInfoCount - 1].endIndex != N) {
+		return false;
+	}
+
+	const bool   isVertical     = m_orientation == Qt::Vertical;
+	const qreal  spacing        = m_spacing;
+	const bool   animateMove    = m_currentAnimation & Move;
+	const QRectF effectiveRect(m_layoutRect);
+	const qreal  cellWidth      = m_layoutCellWidth;
+	const qreal  cellHeight     = m_layoutCellHeight;
+	const qreal  availableWidth = m_layoutAvailableWidth;
+	const qreal *expansion      = m_expansion.constData();
+	const qreal *offset         = m_offset.constData();
+	const RowKernel layoutRow   = rowKernel(isVertical, m_layoutRtl);
+	const qreal  rowStart       = isVertical ? effectiveRect.top()  : effectiveRect.left();
+	qreal        rowOffset      = isVertical ? effectiveRect.left() : effectiveRect.top();
+	qreal maxPreferredRowWidth  = 0.0;
+	RowInfo *rowInfos           = m_rowInfos.data();
+
+	for (int row = 0; row < m_rowInfoCount; ++ row) {
+		RowInfo& rowInfo = rowInfos[row];
+
+		if (rowInfo.startIndex < end && rowInfo.endIndex > begin) {
+			const qreal oldScale    = rowInfo.scale;
+			const qreal oldScaleExp = rowInfo.scaleExp;
+			qreal preferredWidth = 0.0;
+
+			for (int index = rowInfo.startIndex; index < rowInfo.endIndex; ++ index) {
+				preferredWidth += cellWidth + expansion[index];
+			}
+			rowInfo.preferredWidth = preferredWidth;
+			scaleRow(rowInfo, availableWidth);
+
+			// a changed scaling moves every item of the row
+			int firstIndex = rowInfo.startIndex;
+			if (rowInfo.scale == oldScale && rowInfo.scaleExp == oldScaleExp) {
+				firstIndex = qMax(rowInfo.startIndex, begin);
+			}
+
+			qreal pos = rowStart;
+			if (firstIndex > rowInfo.startIndex) {
+				const int last = firstIndex - 1;
+				pos += offset[last] + (cellWidth + expansion[last] * rowInfo.scaleExp) * rowInfo.scale + spacing;
+			}
+
+			pos = (this->*layoutRow)(
+				row, firstIndex, rowInfo.endIndex, pos, rowOffset,
+				cellWidth, cellHeight, rowInfo.scale, rowInfo.scaleExp, effectiveRect, animateMove);
+
+			rowInfo.length = pos - rowStart;
+		}
+
+		maxPreferredRowWidth = qMax(maxPreferredRowWidth, rowInfo.preferredWidth + rowInfo.preferredSpacing);
+		rowOffset += cellHeight + spacing;
 	}
+
+	updatePreferredSize(maxPreferredRowWidth);
+	reportPreferredSize();
+
+	return true;
 }
 
 void TaskbarLayout::expandAt(int index, ExpansionDirection direction) {
@@ -423,13 +828,24 @@ void TaskbarLayout::expandAt(int index, ExpansionDirection direction) {
 		return;
 	}
 
-	TaskbarItem *item = m_items[index];
-
-	if (item->direction != direction) {
-		item->direction = direction;
+	if (m_direction[index] != direction) {
+		m_direction[index] = direction;
+		m_expandedCount += direction == Expand ? 1 : -1;
+		m_persistentPrefixValid = false;
 		int expandAnimation = direction == Collapse ? ResizeCollapse : ResizeExpand;
-		item->animation = (item->animation & ~Resize) | expandAnimation;
+		m_animation[index] = (m_animation[index] & ~Resize) | expandAnimation;
+
+		// a changed direction might change the distribution of the items,
+		// the animation frames only update the row of the item
+		invalidateRange(index, index + 1);
+
+		const bool resizing = m_currentAnimation & Resize;
 		m_currentAnimation |= Resize;
+
+		if (m_stableSizeHint && m_animationsEnabled && !resizing) {
+			// report where this animation ends once instead of every frame
+			reportPreferredSize(targetPreferredSize());
+		}
 		startAnimation();
 	}
 }
@@ -437,15 +853,46 @@ void TaskbarLayout::expandAt(int index, ExpansionDirection direction) {
 qreal TaskbarLayout::additionalWidth() const {
 	// I assume all items to be of the same size. Which size that
 	// is depends on if there are more expanded or collapsed items.
-	int expandedCount = 0;
-	foreach (TaskbarItem *item, m_items) {
-		if (item->direction == Expand) {
-			++ expandedCount;
+	return m_expandedCount - 2 >= m_items.size() - m_expandedCount ?
+		m_expandedWidth : 0.0;
+}
+
+int TaskbarLayout::persistentExpandedCount(int begin, int end) const {
+	if (!m_persistentPrefixValid) {
+		const int N = m_items.size();
+		m_persistentPrefix.resize(N + 1);
+
+		int *prefix = m_persistentPrefix.data();
+		prefix[0] = 0;
+		for (int index = 0; index < N; ++ index) {
+			prefix[index + 1] = prefix[index] +
+				(m_direction[index] == Expand && !m_hoverExpanded[index] ? 1 : 0);
 		}
+		m_persistentPrefixValid = true;
 	}
 
-	return expandedCount - 2 >= m_items.size() - expandedCount ?
-		m_expandedWidth : 0.0;
+	return m_persistentPrefix[end] - m_persistentPrefix[begin];
+}
+
+void TaskbarLayout::setHoverExpanded(int index, bool hoverExpanded) {
+	if (m_hoverExpanded[index] != hoverExpanded) {
+		m_hoverExpanded[index] = hoverExpanded;
+		m_hoverExpandedCount  += hoverExpanded ? 1 : -1;
+		m_persistentPrefixValid = false;
+	}
+}
+
+void TaskbarLayout::expandItem(TaskItem *item, ExpansionDirection direction) {
+	const int index = indexOf(item);
+
+	if (index == -1) {
+		qWarning("TaskbarLayout::expandItem: not a child item");
+		return;
+	}
+
+	// the item emits expand() whenever its expansion state changes
+	setHoverExpanded(index, item->isExpandedByHover());
+	expandAt(index, direction);
 }
 
 TaskItem *TaskbarLayout::itemAt(int index) const {
@@ -453,7 +900,7 @@ TaskItem *TaskbarLayout::itemAt(int index) const {
 		qWarning("TaskbarLayout::itemAt: invalid index %d", index);
 		return NULL;
 	}
-	return m_items[index]->item;
+	return m_items[index];
 }
 
 int TaskbarLayout::addItem(TaskItem *item, bool expanded) {
@@ -467,21 +914,45 @@ void TaskbarLayout::insertItem(int index, TaskItem *item, bool expanded) {
 		qWarning("TaskbarLayout::insertItem: cannot insert null item");
 		return;
 	}
-	if (indexOf(item) != -1) {
+	if (m_indices.contains(item)) {
 		qWarning("TaskbarLayout::insertItem: cannot instert same item twice");
 		return;
 	}
 	item->setParentLayoutItem(this);
-	TaskbarItem *titem = new TaskbarItem(item,
-		expanded ? m_expandedWidth : 0.0,
-		expanded ? Expand : Collapse);
-	m_items.insert(index, titem);
+	m_items.insert(index, item);
+	m_destX.insert(index, 0.0);
+	m_destY.insert(index, 0.0);
+	m_expansion.insert(index, expanded ? m_expandedWidth : 0.0);
+	m_row.insert(index, 0);
+	m_offset.insert(index, 0.0);
+	m_direction.insert(index, expanded ? Expand : Collapse);
+	m_animation.insert(index, None);
+	m_isNew.insert(index, true);
+	m_hoverExpanded.insert(index, expanded && item->isExpandedByHover());
+	m_indices.insert(item, index);
+
+	if (expanded) {
+		++ m_expandedCount;
+	}
+	if (m_hoverExpanded[index]) {
+		++ m_hoverExpandedCount;
+	}
+	m_persistentPrefixValid = false;
+
+	if (index == m_validIndices && index == m_items.size() - 1) {
+		// appended, no other item changed its index
+		++ m_validIndices;
+	}
+	else {
+		invalidateIndices(index);
+	}
 
 	item->setCellSize(cellSize());
 	item->setOrientation(m_orientation);
 	connectItem(item);
 
-	invalidate();
+	// all following items are shifted
+	invalidateRange(index, std::numeric_limits<int>::max());
 }
 
 void TaskbarLayout::connectItem(TaskItem *item) {
@@ -499,8 +970,8 @@ void TaskbarLayout::move(int fromIndex, int toIndex) {
 		return;
 	}
 
-	m_items.move(fromIndex, toIndex);
-	invalidate();
+	moveItemState(fromIndex, toIndex);
+	invalidateRange(qMin(fromIndex, toIndex), qMax(fromIndex, toIndex) + 1);
 }
 
 void TaskbarLayout::removeAt(int index) {
@@ -509,20 +980,20 @@ void TaskbarLayout::removeAt(int index) {
 		return;
 	}
 
-	TaskbarItem *item = m_items.takeAt(index);
+	TaskItem *item = m_items[index];
+	removeItemState(index);
 
 	if (m_draggedItem == item) {
 		m_currentIndex  = -1;
 		m_draggedItem   = NULL;
 	}
 
-	disconnectItem(item->item);
-
-	delete item;
+	disconnectItem(item);
+	releaseItem(item);
 	if (m_items.isEmpty()) {
 		stopAnimation();
 	}
-	invalidate();
+	invalidateRange(index, std::numeric_limits<int>::max());
 }
 
 void TaskbarLayout::removeItem(TaskItem *item) {
@@ -536,35 +1007,53 @@ void TaskbarLayout::removeItem(TaskItem *item) {
 
 TaskItem *TaskbarLayout::itemAt(const QPointF& pos) const {
 	const qreal halfSpacing = m_spacing * 0.5;
+	const int   N           = m_items.size();
+	const int   index       = indexOf(pos);
+
+	// The item that will be at pos or one of its neighbours is hit unless
+	// items are still moving.
+	for (int candidate = qMax(0, index - 1); candidate <= index + 1 && candidate < N; ++ candidate) {
+		if (hits(m_items[candidate], pos, halfSpacing)) {
+			return m_items[candidate];
+		}
+	}
 
-	foreach (TaskbarItem *item, m_items) {
-		QRectF rect = item->item->geometry();
-		qreal y = rect.y();
-		qreal x = rect.x();
-		if (
-				pos.y() >= (y - halfSpacing) && pos.y() < (y + rect.height() + halfSpacing) &&
-				pos.x() >= (x - halfSpacing) && pos.x() < (x + rect.width()  + halfSpacing)) {
-			return item->item;
+	// Moving items can be any distance away from their destination.
+	if (m_currentAnimation != None) {
+		foreach (TaskItem *item, m_items) {
+			if (hits(item, pos, halfSpacing)) {
+				return item;
+			}
 		}
 	}
 
 	return NULL;
 }
 
+qreal TaskbarLayout::ungroupedCompression() const {
+	return std::numeric_limits<qreal>::infinity();
+}
+
+bool TaskbarLayout::isResizing(TaskItem *item) const {
+	const int index = indexOf(item);
+
+	return index != -1 && (m_animation[index] & Resize);
+}
+
 int TaskbarLayout::rowOf(TaskItem *item) const {
 	if (item == NULL) {
 		qWarning("TaskbarLayout::rowOf: item cannot be null");
 		return -1;
 	}
 
-	foreach (TaskbarItem* titem, m_items) {
-		if (titem->item == item) {
-			return titem->row;
-		}
+	const int index = indexOf(item);
+
+	if (index == -1) {
+		qWarning("TaskbarLayout::rowOf: not a child item");
+		return -1;
 	}
 
-	qWarning("TaskbarLayout::rowOf: not a child item");
-	return -1;
+	return m_row[index];
 }
 
 int TaskbarLayout::rowOf(int index) const {
@@ -573,135 +1062,118 @@ int TaskbarLayout::rowOf(int index) const {
 		return -1;
 	}
 
-	return m_items[index]->row;
+	return m_row[index];
 }
 
-int TaskbarLayout::rowOf(const QPointF& pos) const {
-	QRectF effectiveRect(effectiveGeometry());
+template<bool Vertical>
+int TaskbarLayout::rowAt(const QPointF& pos, const QRectF& effectiveRect) const {
+	// the position across the rows
+	const qreal across = Vertical ? pos.x()               : pos.y();
+	const qreal start  = Vertical ? effectiveRect.left()  : effectiveRect.top();
+	const qreal end    = Vertical ? effectiveRect.right() : effectiveRect.bottom();
+	const qreal size   = Vertical ? effectiveRect.width() : effectiveRect.height();
 
-	if (m_orientation == Qt::Vertical) {
-		qreal x = pos.x();
-		if (x <= effectiveRect.left()) {
-			return 0;
-		}
-		else if (x >= effectiveRect.right() || effectiveRect.width() == 0) {
-			return m_rows - 1;
-		}
-		else {
-			return (int) ((x - effectiveRect.left()) * m_rows / effectiveRect.width());
-		}
+	if (across <= start) {
+		return 0;
+	}
+	else if (across >= end || size == 0) {
+		return m_rows - 1;
 	}
 	else {
-		qreal y = pos.y();
-		if (y <= effectiveRect.top()) {
-			return 0;
-		}
-		else if (y >= effectiveRect.bottom() || effectiveRect.height() == 0) {
-			return m_rows - 1;
-		}
-		else {
-			return (int) ((y - effectiveRect.top()) * m_rows / effectiveRect.height());
-		}
+		return (int) ((across - start) * m_rows / size);
 	}
 }
 
-int TaskbarLayout::indexOf(const QPointF& pos, int *rowptr) const {
+int TaskbarLayout::rowOf(const QPointF& pos) const {
 	const QRectF effectiveRect(effectiveGeometry());
-	const int    row         = rowOf(pos);
-	const qreal  halfSpacing = m_spacing * 0.5;
-	const bool   rtl         = QApplication::isRightToLeft();
-	const bool   isVertical  = m_orientation == Qt::Vertical;
-	const int    N           = m_items.size();
-
-	int rowStart = 0;
-	int rowEnd   = N;
-
-	// find first of row:
-	for (; rowStart < N; ++ rowStart) {
-		if (m_items[rowStart]->row == row) {
-			break;
-		}
-	}
 
-	if (rowptr) {
-		*rowptr = row;
-	}
+	return m_orientation == Qt::Vertical ?
+		rowAt<true>(pos, effectiveRect) :
+		rowAt<false>(pos, effectiveRect);
+}
+
+template<bool Vertical, bool Rtl>
+int TaskbarLayout::indexInRow(const QPointF& pos, const QRectF& effectiveRect, int row) const {
+	const int N = m_items.size();
 
-	if (rowStart == N) {
+	if (row < 0 || row >= m_rowInfoCount) {
 		return N;
 	}
-	else if (rowStart > N) {
-		qDebug(
-			"TaskbarLayout::indexOf: Bug: rowStart (%d) is bigger than item count (%d)!",
-			rowStart, N);
+
+	// the rows are those of the last layout pass, so they might reach
+	// beyond items that were removed since then
+	const RowInfo& rowInfo  = m_rowInfos[row];
+	const int      rowStart = qMin(rowInfo.startIndex, N);
+	const int      rowEnd   = qMin(rowInfo.endIndex,   N);
+
+	if (rowStart == rowEnd) {
 		return N;
 	}
 
-	qreal relevantPos;
+	// the position measured from where the row starts:
+	qreal relevantPos = Vertical ?
+		(Rtl ? effectiveRect.bottom() - pos.y() : pos.y() - effectiveRect.top()) :
+		(Rtl ? effectiveRect.right()  - pos.x() : pos.x() - effectiveRect.left());
 
-	if (isVertical) {
-		relevantPos = pos.y();
-
-		if (rtl) {
-			if (relevantPos > effectiveRect.bottom()) {
-				return rowStart;
-			}
-		}
-		else {
-			if (relevantPos < effectiveRect.top()) {
-				return rowStart;
-			}
-		}
+	if (relevantPos < 0) {
+		return rowStart;
 	}
-	else {
-		relevantPos = pos.x();
 
-		if (rtl) {
-			if (relevantPos > effectiveRect.right()) {
-				return rowStart;
-			}
-		}
-		else {
-			if (relevantPos < effectiveRect.left()) {
-				return rowStart;
-			}
-		}
+	// every item covers the area up to the middle of the spacing around it
+	relevantPos += m_spacing * 0.5;
+
+	if (relevantPos >= rowInfo.length) {
+		return rowEnd;
 	}
 
-	for (int index = rowStart; index < N; ++ index) {
-		TaskbarItem* item = m_items[index];
-			
-		if (item->row != row) {
-			rowEnd = index;
-			break;
-		}
+	const qreal *offset = m_offset.constData();
+	const int    index  = std::upper_bound(offset + rowStart, offset + rowEnd, relevantPos) - offset - 1;
 
-		qreal start = isVertical ?
-			item->destY - halfSpacing :
-			item->destX - halfSpacing;
+	return qMax(index, rowStart);
+}
 
-		qreal end = isVertical ?
-			item->destY + item->item->geometry().height() + halfSpacing :
-			item->destX + item->item->geometry().width()  + halfSpacing;
-			
-		if (relevantPos >= start && relevantPos < end) {
-			return index;
-		}
+int TaskbarLayout::indexOf(const QPointF& pos, int *rowptr) const {
+	const QRectF effectiveRect(effectiveGeometry());
+	const int    row = rowOf(pos);
+
+	if (rowptr) {
+		*rowptr = row;
 	}
 
-	return rowEnd;
+	if (m_orientation == Qt::Vertical) {
+		return QApplication::isRightToLeft() ?
+			indexInRow<true, true>(pos, effectiveRect, row) :
+			indexInRow<true, false>(pos, effectiveRect, row);
+	}
+	else {
+		return QApplication::isRightToLeft() ?
+			indexInRow<false, true>(pos, effectiveRect, row) :
+			indexInRow<false, false>(pos, effectiveRect, row);
+	}
 }
 
 int TaskbarLayout::indexOf(TaskItem *item) const {
+	const int index = m_indices.value(item, -1);
+
+	if (index < m_validIndices) {
+		return index;
+	}
+
+	// renumber the items that changed their position since the last lookup
 	const int N = m_items.size();
-	
-	for (int index = 0; index < N; ++ index) {
-		if (m_items[index]->item == item) {
-			return index;
-		}
+
+	for (int other = m_validIndices; other < N; ++ other) {
+		m_indices[m_items[other]] = other;
 	}
+	m_validIndices = N;
 
-	return -1;
+	return m_indices.value(item);
+}
+
+void TaskbarLayout::invalidateIndices(int index) {
+	if (index < m_validIndices) {
+		m_validIndices = index;
+	}
 }
 
 void TaskbarLayout::takeFrom(TaskbarLayout *other) {
@@ -716,18 +1188,48 @@ void TaskbarLayout::takeFrom(TaskbarLayout *other) {
 	m_currentAnimation = other->m_currentAnimation;
 	m_mouseIn          = other->m_mouseIn;
 	m_grabPos          = other->m_grabPos;
+	invalidateIndices(m_items.size());
+	foreach (TaskItem *item, other->m_items) {
+		m_indices.insert(item, m_items.size());
+	}
 	m_items.append(other->m_items);
-
-	foreach (TaskbarItem *item, other->m_items) {
-		item->item->setParentLayoutItem(this);
-		other->disconnectItem(item->item);
-		connectItem(item->item);
+	m_destX              += other->m_destX;
+	m_destY              += other->m_destY;
+	m_expansion          += other->m_expansion;
+	m_row                += other->m_row;
+	m_offset             += other->m_offset;
+	m_direction          += other->m_direction;
+	m_animation          += other->m_animation;
+	m_isNew              += other->m_isNew;
+	m_hoverExpanded      += other->m_hoverExpanded;
+	m_expandedCount      += other->m_expandedCount;
+	m_hoverExpandedCount += other->m_hoverExpandedCount;
+	m_persistentPrefixValid = false;
+
+	foreach (TaskItem *item, other->m_items) {
+		item->setParentLayoutItem(this);
+		other->disconnectItem(item);
+		connectItem(item);
 	}
 
 	other->m_draggedItem  = NULL;
 	other->m_currentIndex = -1;
 	other->m_mouseIn      = false;
 	other->m_items.clear();
+	other->m_indices.clear();
+	other->m_validIndices = 0;
+	other->m_destX.clear();
+	other->m_destY.clear();
+	other->m_expansion.clear();
+	other->m_row.clear();
+	other->m_offset.clear();
+	other->m_direction.clear();
+	other->m_animation.clear();
+	other->m_isNew.clear();
+	other->m_hoverExpanded.clear();
+	other->m_expandedCount         = 0;
+	other->m_hoverExpandedCount    = 0;
+	other->m_persistentPrefixValid = false;
 	other->stopAnimation();
 
 	if (m_currentAnimation != None) {
@@ -738,47 +1240,63 @@ void TaskbarLayout::takeFrom(TaskbarLayout *other) {
 }
 
 int TaskbarLayout::dragItem(TaskItem *item, QDrag *drag, const QPointF& pos) {
+	int index = beginDrag(item, pos);
+
+	if (index == -1) {
+		return -1;
+	}
+
+	int dropIndex = index;
+
+	if (drag->exec(Qt::MoveAction) == Qt::IgnoreAction || drag->target() == drag->source()) {
+		dropIndex = currentDragIndex();
+	}
+
+	if (m_draggedItem != NULL && m_draggedItem != item) {
+		qWarning(
+			"TaskbarLayout::dragItem: dragged item changed during dragging!?\n"
+			"This _might_ cause a memleak under some circumstances.");
+		return -1;
+	}
+
+	return endDrag(dropIndex);
+}
+
+int TaskbarLayout::beginDrag(TaskItem *item, const QPointF& pos) {
 	if (m_draggedItem != NULL) {
-		qWarning("TaskbarLayout::dragItem: already dragging");
+		qWarning("TaskbarLayout::beginDrag: already dragging");
 		return -1;
 	}
 
 	int index = indexOf(item);
 
 	if (index == -1) {
-		qWarning("TaskbarLayout::dragItem: invalid item");
+		qWarning("TaskbarLayout::beginDrag: invalid item");
 		return -1;
 	}
 
 	m_mouseIn      = true;
-	m_draggedItem  = m_items[index];
+	m_draggedItem  = item;
 	m_currentIndex = index;
-	m_grabPos      = pos - m_draggedItem->item->geometry().topLeft();
+	m_grabPos      = pos - item->geometry().topLeft();
 
-	bool enabled = m_draggedItem->item->graphicsItem()->isEnabled();
+	m_draggedItemEnabled = item->graphicsItem()->isEnabled();
 
-	m_draggedItem->item->graphicsItem()->setZValue(1);
-	m_draggedItem->item->graphicsItem()->setEnabled(false);
-
-	int dropIndex = index;
+	item->graphicsItem()->setZValue(1);
+	item->graphicsItem()->setEnabled(false);
 
 	m_currentAnimation |= Move;
-	if (drag->exec(Qt::MoveAction) == Qt::IgnoreAction || drag->target() == drag->source()) {
-		dropIndex = currentDragIndex();
-	}
 
+	return index;
+}
+
+int TaskbarLayout::endDrag(int dropIndex) {
 	if (m_draggedItem == NULL) {
-		qDebug("TaskbarLayout::dragItem: item was deleted during dragging");
-	}
-	else if (m_draggedItem->item != item) {
-		qWarning(
-			"TaskbarLayout::dragItem: dragged item changed during dragging!?\n"
-			"This _might_ cause a memleak under some circumstances.");
-		return -1;
+		qDebug("TaskbarLayout::endDrag: item was deleted during dragging");
 	}
 	else {
-		m_draggedItem->item->graphicsItem()->setZValue(0);
-		m_draggedItem->item->graphicsItem()->setEnabled(enabled);
+		m_draggedItem->graphicsItem()->setZValue(0);
+		m_draggedItem->graphicsItem()->setEnabled(m_draggedItemEnabled);
 
 		if (dropIndex >= 0) {
 			// move dropped item animated to dest:
@@ -799,7 +1317,7 @@ void TaskbarLayout::moveDraggedItem(const QPointF& pos) {
 	}
 
 	m_mouseIn = true;
-	QRectF rect(m_draggedItem->item->geometry());
+	QRectF rect(m_draggedItem->geometry());
 	QRectF effectiveRect(effectiveGeometry());
 
 	if (m_grabPos.y() > rect.height()) {
@@ -828,7 +1346,7 @@ void TaskbarLayout::moveDraggedItem(const QPointF& pos) {
 
 	rect.moveTopLeft(newPos);
 
-	m_draggedItem->item->setGeometry(rect);
+	m_draggedItem->setGeometry(rect);
 
 	int row   = 0;
 	int index = indexOf(pos, &row);
@@ -837,9 +1355,10 @@ void TaskbarLayout::moveDraggedItem(const QPointF& pos) {
 		-- index;
 	}
 	
-	m_items.move(m_currentIndex, index);
+	markDirty(qMin(m_currentIndex, index), qMax(m_currentIndex, index) + 1);
+	moveItemState(m_currentIndex, index);
 	m_currentIndex     = index;
-	m_draggedItem->row = row;
+	m_row[index]       = row;
 	m_currentAnimation |= Move;
 	doLayout();
 }
@@ -853,45 +1372,47 @@ void TaskbarLayout::dragLeave() {
 	startAnimation();
 }
 
-void TaskbarLayout::animate(TaskbarItem *item, qreal move, qreal expand) {
-	QRectF rect(item->item->geometry());
+void TaskbarLayout::animate(int index, qreal move, qreal expand) {
+	TaskItem *item = m_items[index];
+	int animation  = m_animation[index];
+	QRectF rect(item->geometry());
 	
 	if (item != m_draggedItem || !m_mouseIn) {
 		qreal x = rect.x();
 		qreal y = rect.y();
 		
-		if (item->animation & MoveY) {
-			if (y < item->destY) {
+		if (animation & MoveY) {
+			if (y < m_destY[index]) {
 				y += move;
-				if (y >= item->destY) {
-					y = item->destY;
-					item->animation &= ~MoveY;
+				if (y >= m_destY[index]) {
+					y = m_destY[index];
+					animation &= ~MoveY;
 				}
 			}
 			else {
 				y -= move;
-				if (y <= item->destY) {
-					y = item->destY;
-					item->animation &= ~MoveY;
+				if (y <= m_destY[index]) {
+					y = m_destY[index];
+					animation &= ~MoveY;
 				}
 			}
 			
 			rect.moveTop(y);
 		}
 		
-		if (item->animation & MoveX) {
-			if (x < item->destX) {
-				x += PIXELS_PER_SECOND / m_fps;
-				if (x >= item->destX) {
-					x = item->destX;
-					item->animation &= ~MoveX;
+		if (animation & MoveX) {
+			if (x < m_destX[index]) {
+				x += move;
+				if (x >= m_destX[index]) {
+					x = m_destX[index];
+					animation &= ~MoveX;
 				}
 			}
 			else {
-				x -= PIXELS_PER_SECOND / m_fps;
-				if (x <= item->destX) {
-					x = item->destX;
-					item->animation &= ~MoveX;
+				x -= move;
+				if (x <= m_destX[index]) {
+					x = m_destX[index];
+					animation &= ~MoveX;
 				}
 			}
 			
@@ -899,52 +1420,64 @@ void TaskbarLayout::animate(TaskbarItem *item, qreal move, qreal expand) {
 		}
 	}
 
-	if (item->animation & ResizeCollapse) {
-		item->expansion -= expand;
+	if (animation & ResizeCollapse) {
+		m_expansion[index] -= expand;
 
-		if (item->expansion <= 0.0) {
-			item->expansion = 0.0;
-			item->animation &= ~ResizeCollapse;
+		if (m_expansion[index] <= 0.0) {
+			m_expansion[index] = 0.0;
+			animation &= ~ResizeCollapse;
 		}
 	}
-	else if (item->animation & ResizeExpand) {
-		item->expansion += expand;
+	else if (animation & ResizeExpand) {
+		m_expansion[index] += expand;
 
-		if (item->expansion >= m_expandedWidth) {
-			item->expansion = m_expandedWidth;
-			item->animation &= ~ResizeExpand;
+		if (m_expansion[index] >= m_expandedWidth) {
+			m_expansion[index] = m_expandedWidth;
+			animation &= ~ResizeExpand;
 		}
 	}
 	
-	item->item->setGeometry(rect);
+	m_animation[index] = animation;
+	setItemGeometry(item, rect);
 }
 
 void TaskbarLayout::animate() {
-	int   now         = Midnight.msecsTo(QTime::currentTime());
-	int   msecs       = now < m_timeStamp ? 1000 / m_fps : now - m_timeStamp;
+	const qint64 now  = m_animationClock->now();
+	// a clock that was replaced might have gone backwards
+	int   msecs       = now < m_timeStamp ? 1000 / m_fps :
+		(int) qMin<qint64>(now - m_timeStamp, std::numeric_limits<int>::max());
 	int   didAnimate  = None;
 	int   willAnimate = None;
 	qreal move        = msecs * PIXELS_PER_SECOND / 1000;
 	qreal expand      = msecs * m_expandedWidth / m_expandDuration;
+	const int N       = m_items.size();
+	int resizedBegin  = N;
+	int resizedEnd    = 0;
 	m_timeStamp = now;
 
-	foreach (TaskbarItem *item, m_items) {
-		if (item->animation != None) {
-			didAnimate |= item->animation;
-			animate(item, move, expand);
-			willAnimate |= item->animation;
+	for (int index = 0; index < N; ++ index) {
+		const int animation = m_animation[index];
+
+		if (animation != None) {
+			if (animation & Resize) {
+				resizedBegin = qMin(resizedBegin, index);
+				resizedEnd   = index + 1;
+			}
+			didAnimate |= animation;
+			animate(index, move, expand);
+			willAnimate |= m_animation[index];
 		}
 	}
 
+	m_currentAnimation = willAnimate;
+
 	if (willAnimate == None) {
 		stopAnimation();
 	}
 	
-	if (didAnimate & Resize) {
-		invalidate();
+	if (didAnimate & Resize && !updateRows(resizedBegin, resizedEnd)) {
+		invalidateRange(resizedBegin, resizedEnd);
 	}
-	
-	m_currentAnimation = willAnimate;
 }
 
 void TaskbarLayout::disconnectItem(TaskItem *item) {
@@ -952,38 +1485,44 @@ void TaskbarLayout::disconnectItem(TaskItem *item) {
 }
 
 void TaskbarLayout::startAnimation() {
-	if (m_animationsEnabled && !m_animationTimer->isActive()) {
-		m_timeStamp = Midnight.msecsTo(QTime::currentTime());
-		m_animationTimer->start();
+	if (m_animationsEnabled && m_animationTrack == 0) {
+		m_timeStamp      = m_animationClock->now();
+		m_animationTrack = AnimationDriver::self()->startTicker(m_fps, this, "animate");
 	}
 }
 
 void TaskbarLayout::stopAnimation() {
-	m_animationTimer->stop();
+	if (m_animationTrack != 0) {
+		AnimationDriver::self()->stop(m_animationTrack);
+		m_animationTrack = 0;
+	}
 	m_currentAnimation = None;
 }
 
 void TaskbarLayout::skipAnimation() {
 	stopAnimation();
 
-	foreach (TaskbarItem *item, m_items) {
-		QRectF rect(item->item->geometry());
+	const int N = m_items.size();
+
+	for (int index = 0; index < N; ++ index) {
+		TaskItem *item = m_items[index];
+		QRectF rect(item->geometry());
 
 		if (item != m_draggedItem || !m_mouseIn) {
-			rect.moveTop(item->destY);
-			rect.moveLeft(item->destX);
+			rect.moveTop(m_destY[index]);
+			rect.moveLeft(m_destX[index]);
 		}
 
-		switch (item->direction) {
+		switch (m_direction[index]) {
 		case Collapse:
-			item->expansion = 0.0;
+			m_expansion[index] = 0.0;
 			break;
 		case Expand:
-			item->expansion = m_expandedWidth;
+			m_expansion[index] = m_expandedWidth;
 			break;
 		}
 		
-		item->item->setGeometry(rect);
+		setItemGeometry(item, rect);
 	}
 
 	// TODO: maybe only call invalidate if necesarry
@@ -991,35 +1530,77 @@ void TaskbarLayout::skipAnimation() {
 }
 
 TaskItem *TaskbarLayout::draggedItem() const {
-	if (m_draggedItem) {
-		return m_draggedItem->item;
-	}
-	else {
-		return NULL;
-	}
+	return m_draggedItem;
 }
 
 void TaskbarLayout::clear(bool forceDeleteItems) {
 	stopAnimation();
 
 	while (!m_items.isEmpty()) {
-		TaskbarItem *item = m_items.takeLast();
-		TaskItem *titem = item->item;
-
-		if (titem != NULL) {
-			disconnectItem(titem);
-			if (forceDeleteItems && !titem->ownedByLayout()) {
-				delete titem;
-				item->item = NULL;
-			}
+		TaskItem *item = m_items.last();
+		removeItemState(m_items.size() - 1);
+
+		disconnectItem(item);
+		if (forceDeleteItems && !item->ownedByLayout()) {
+			delete item;
+		}
+		else {
+			releaseItem(item);
 		}
-		delete item;
 	}
 
 	if (m_draggedItem) {
 		m_currentIndex = -1;
 		m_draggedItem  = NULL;
 	}
+
+	m_rowInfoCount = 0;
+	markDirty(0, std::numeric_limits<int>::max());
+}
+
+void TaskbarLayout::moveItemState(int fromIndex, int toIndex) {
+	invalidateIndices(qMin(fromIndex, toIndex));
+	m_items.move(fromIndex, toIndex);
+	moveElement(m_destX,         fromIndex, toIndex);
+	moveElement(m_destY,         fromIndex, toIndex);
+	moveElement(m_expansion,     fromIndex, toIndex);
+	moveElement(m_row,           fromIndex, toIndex);
+	moveElement(m_offset,        fromIndex, toIndex);
+	moveElement(m_direction,     fromIndex, toIndex);
+	moveElement(m_animation,     fromIndex, toIndex);
+	moveElement(m_isNew,         fromIndex, toIndex);
+	moveElement(m_hoverExpanded, fromIndex, toIndex);
+	m_persistentPrefixValid = false;
+}
+
+void TaskbarLayout::removeItemState(int index) {
+	invalidateIndices(index);
+	m_indices.remove(m_items[index]);
+	m_items.removeAt(index);
+	m_destX.remove(index);
+	m_destY.remove(index);
+	m_expansion.remove(index);
+	m_row.remove(index);
+	m_offset.remove(index);
+	if (m_direction[index] == Expand) {
+		-- m_expandedCount;
+	}
+	if (m_hoverExpanded[index]) {
+		-- m_hoverExpandedCount;
+	}
+	m_persistentPrefixValid = false;
+
+	m_direction.remove(index);
+	m_animation.remove(index);
+	m_isNew.remove(index);
+	m_hoverExpanded.remove(index);
+}
+
+void TaskbarLayout::releaseItem(TaskItem *item) {
+	item->setParentLayoutItem(NULL);
+	if (item->ownedByLayout()) {
+		delete item;
+	}
 }
 
 } // namespace SmoothTasks
@@ -21,20 +21,56 @@
 #define SMOOTHTASKS_TASKBARLAYOUT_H
 
 #include <QGraphicsLayout>
+#include <QHash>
 #include <QList>
 #include <QPointer>
 #include <QObject>
-#include <QTime>
+#include <QVector>
 
+#include "SmoothTasks/AnimationClock.h"
 #include "SmoothTasks/ExpansionDirection.h"
 #include "SmoothTasks/TaskItem.h"
 
+class QDrag;
+
 namespace SmoothTasks {
 
 class TaskItem;
 class TaskbarLayout;
-class TaskbarItem;
-class RowInfo;
+
+class RowInfo {
+
+	public:
+		RowInfo()
+			: preferredWidth(0.0),
+			  minimumWidth(0.0),
+			  preferredSpacing(0.0),
+			  startIndex(0),
+			  endIndex(0),
+			  scale(1.0),
+			  scaleExp(0.0),
+			  length(0.0) {}
+
+		RowInfo(qreal preferredWidth, qreal minimumWidth, int startIndex, int endIndex, qreal preferredSpacing)
+			: preferredWidth(preferredWidth),
+			  minimumWidth(minimumWidth),
+			  preferredSpacing(preferredSpacing),
+			  startIndex(startIndex),
+			  endIndex(endIndex),
+			  scale(1.0),
+			  scaleExp(0.0),
+			  length(0.0) {}
+
+		qreal preferredWidth;
+		qreal minimumWidth;
+		qreal preferredSpacing; // spacing counted for the preferred size
+		int   startIndex;
+		int   endIndex;
+		// set by updateLayout():
+		qreal scale;
+		qreal scaleExp;
+		qreal length; // including the spacing after the last item
+};
 
 class TaskbarLayout : public QObject, public QGraphicsLayout {
 	Q_OBJECT
@@ -51,8 +87,8 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 	Q_PROPERTY(qreal expandedWidth READ expandedWidth WRITE setExpandedWidth)
 	Q_PROPERTY(qreal aspectRatio READ aspectRatio WRITE setAspectRatio)
 	Q_PROPERTY(qreal expandDuration READ expandDuration WRITE setExpandDuration)
-	
-	friend class TaskbarItem;
+	Q_PROPERTY(bool stableSizeHint READ stableSizeHint WRITE setStableSizeHint)
+	Q_PROPERTY(bool pixelSnapping READ pixelSnapping WRITE setPixelSnapping)
 	
 	public:
 		enum TaskbarLayoutType {
@@ -70,11 +106,19 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 
 		void takeFrom(TaskbarLayout *other);
 		int  dragItem(TaskItem *item, QDrag *drag, const QPointF& pos);
+		int  beginDrag(TaskItem *item, const QPointF& pos);
+		int  endDrag(int dropIndex);
 		void moveDraggedItem(const QPointF& pos);
 		void dragLeave();
 
 		QSizeF sizeHint(Qt::SizeHint which, const QSizeF& constraint = QSizeF()) const;
 		void   setGeometry(const QRectF& rect);
+		void   invalidate();
+		void   invalidateRange(int begin, int end);
+
+		void beginBatch();
+		void commitBatch();
+		bool isBatching() const { return m_batchDepth > 0; }
 
 		void      clear(bool forceDeleteItems = false);
 		void      startAnimation();
@@ -92,10 +136,17 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 		int       indexOf(TaskItem *item) const;
 		int       rowOf(TaskItem *item) const;
 		int       rowOf(int index) const;
+		// whether the item is being expanded or collapsed by an animation
+		bool      isResizing(TaskItem *item) const;
 		int       currentDragIndex() const { return m_currentIndex; }
 		bool      isDragging() const { return m_draggedItem != NULL; }
 
 		virtual int optimumCapacity() const = 0;
+		// How much the items would be compressed if every task had its own
+		// item, independent of the current grouping. The capacity controller
+		// only ungroups once it is clearly above the value it grouped at.
+		// Layouts that do not compress their items return infinity.
+		virtual qreal ungroupedCompression() const;
 
 		virtual TaskbarLayoutType type() const = 0;
 
@@ -107,6 +158,8 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 		qreal spacing() const { return m_spacing; }
 		void  setSpacing(qreal spacing);
 
+		// The frames are ticked by the AnimationDriver, this is only the
+		// frame length assumed if the animation clock went backwards.
 		int  fps() const { return m_fps; }
 		void setFps(int fps);
 
@@ -136,12 +189,33 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 		int  expandDuration() const { return m_expandDuration; }
 		void setExpandDuration(int expandDuration);
 
-		QSizeF preferredSize() const { return m_preferredSize; }
+		// When enabled the preferred size does not follow every frame of an
+		// expand or collapse animation. It is set to the size at the end of
+		// the animation when it starts and corrected when it ends if needed.
+		bool stableSizeHint() const { return m_stableSizeHint; }
+		void setStableSizeHint(bool stableSizeHint);
+
+		// the preferred size as reported by sizeHint()
+		QSizeF preferredSize() const { return m_reportedPreferredSize; }
+
+		// When enabled the destinations of the items are rounded to whole
+		// pixels, so sub-pixel differences between passes don't move them.
+		bool pixelSnapping() const { return m_pixelSnapping; }
+		void setPixelSnapping(bool pixelSnapping);
+
+		// Geometries set on the items and those skipped because the item
+		// already had that geometry, since resetGeometryCounters().
+		int  geometryUpdates()        const { return m_geometryUpdates; }
+		int  skippedGeometryUpdates() const { return m_skippedGeometryUpdates; }
+		void resetGeometryCounters();
+
+		// The clock the animations are timed with. It is not owned by the
+		// layout, pass NULL to go back to the monotonic default clock.
+		AnimationClock *animationClock() const { return m_animationClock; }
+		void            setAnimationClock(AnimationClock *clock);
 	
 	public slots:
-		void expandItem(TaskItem *item, ExpansionDirection direction) {
-			expandAt(indexOf(item), direction);
-		}
+		void expandItem(TaskItem *item, ExpansionDirection direction);
 
 	protected:
 
@@ -158,24 +232,38 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 			Fade           = FadeIn | FadeOut
 		};
 
-		const QList<TaskbarItem*>& items() const { return m_items; }
+		const QVector<qreal>& expansions() const { return m_expansion; }
 		QRectF       effectiveGeometry()   const;
 		qreal        additionalWidth()     const;
 		int          currentAnimation()    const { return m_currentAnimation; }
-		TaskbarItem *draggedTaskbarItem()  const { return m_draggedItem; }
+		bool         isExpandedAt(int index) const { return m_direction[index] == Expand; }
+
+		// Kept up to date as items are added, removed and expanded, so the
+		// layouts don't have to ask every item in every pass.
+		int expandedCount()      const { return m_expandedCount; }
+		int hoverExpandedCount() const { return m_hoverExpandedCount; }
+		// number of items in [begin, end) that are expanded but not by hovering
+		int persistentExpandedCount(int begin, int end) const;
 
 		virtual int  rowOf(const QPointF& pos) const;
 		virtual void doLayout() = 0;
 
+		void setPreferredSize(const QSizeF& preferredSize);
+
+		// The rows of the layout pass in progress. They are kept in a buffer
+		// that is reused by every pass, so a pass does not allocate.
+		void clearRows() { m_newRowInfoCount = 0; }
+		void appendRow(const RowInfo& rowInfo);
+		int  rowInfoCount() const { return m_newRowInfoCount; }
+
 		void buildRows(
 			const int itemsPerRow, const qreal cellWidth,
-			QList<RowInfo>& rowInfos, int& rows,
-			qreal& maxPreferredRowWidth) const;
+			int& rows, qreal& maxPreferredRowWidth);
 
 		void updateLayout(
 			const int rows, const qreal cellWidth, const qreal cellHeight,
 			const qreal availableWidth, const qreal maxPreferredRowWidth,
-			const QList<RowInfo>& rowInfos, const QRectF& effectiveRect);
+			const QRectF& effectiveRect);
 
 	signals:
 		void sizeHintChanged(Qt::SizeHint which);
@@ -185,20 +273,85 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 
 	private:
 		static const qreal PIXELS_PER_SECOND;
+		static const qreal GEOMETRY_TOLERANCE;
 
 		int indexOf(const QPointF& pos, int *row = NULL) const;
-		void animate(TaskbarItem *item, qreal move, qreal expand);
+
+		// Kernels specialized on orientation and direction, see the .cpp.
+		typedef qreal (TaskbarLayout::*RowKernel)(
+			int, int, int, qreal, qreal, qreal, qreal, qreal, qreal,
+			const QRectF&, bool);
+
+		template<bool Vertical, bool Rtl>
+		qreal layoutRow(
+			const int row, const int firstIndex, const int endIndex,
+			qreal pos, const qreal rowOffset,
+			const qreal cellWidth, const qreal cellHeight,
+			const qreal scale, const qreal scaleExp,
+			const QRectF& effectiveRect, const bool animateMove);
+		template<bool Vertical, bool Rtl>
+		int indexInRow(const QPointF& pos, const QRectF& effectiveRect, int row) const;
+		template<bool Vertical>
+		int rowAt(const QPointF& pos, const QRectF& effectiveRect) const;
+
+		RowKernel rowKernel(bool isVertical, bool rtl) const;
+		void scaleRow(RowInfo& rowInfo, qreal availableWidth) const;
+		void updatePreferredSize(qreal maxPreferredRowWidth);
+		bool updateRows(int begin, int end);
+
+		void markDirty(int begin, int end);
+		bool isDirty(int begin, int end) const {
+			return m_dirtyBegin < end && m_dirtyEnd > begin;
+		}
+		void animate(int index, qreal move, qreal expand);
 		void connectItem(TaskItem *item);
 		void disconnectItem(TaskItem *item);
-
-		TaskbarItem         *m_draggedItem;
+		void moveItemState(int fromIndex, int toIndex);
+		void removeItemState(int index);
+		void invalidateIndices(int index);
+		void setHoverExpanded(int index, bool hoverExpanded);
+		void reportPreferredSize();
+		void reportPreferredSize(const QSizeF& preferredSize);
+		QSizeF targetPreferredSize() const;
+		void releaseItem(TaskItem *item);
+		void setItemGeometry(TaskItem *item, const QRectF& rect);
+
+		TaskItem            *m_draggedItem;
 		int                  m_currentIndex;
 		int                  m_currentAnimation;
 		bool                 m_mouseIn;
-		QList<TaskbarItem*>  m_items;
+		bool                 m_draggedItemEnabled;
+
+		// The state of the items is kept in parallel arrays so the loops run
+		// per layout pass and per animation frame stay on contiguous memory.
+		// All of them are indexed like m_items.
+		QList<TaskItem*>            m_items;
+		QVector<qreal>              m_destX;
+		QVector<qreal>              m_destY;
+		QVector<qreal>              m_expansion;
+		QVector<int>                m_row;
+		QVector<qreal>              m_offset; // distance to the start of the row
+		QVector<ExpansionDirection> m_direction;
+		QVector<int>                m_animation;
+		QVector<bool>               m_isNew;
+		QVector<bool>               m_hoverExpanded;
+
+		// items with direction Expand and items expanded by hovering
+		int                  m_expandedCount;
+		int                  m_hoverExpandedCount;
+
+		// m_persistentPrefix[i] is persistentExpandedCount(0, i), rebuilt
+		// on the first query after the expansion of an item changed
+		mutable QVector<int> m_persistentPrefix;
+		mutable bool         m_persistentPrefixValid;
+
+		// Maps the items to their index. Only the indices below m_validIndices
+		// are up to date, the others are renumbered on the next lookup.
+		mutable QHash<TaskItem*, int> m_indices;
+		mutable int                   m_validIndices;
 		Qt::Orientation      m_orientation;
 		qreal                m_spacing;
-		QTimer              *m_animationTimer;
+		int                  m_animationTrack; // ticker of the AnimationDriver, 0 if stopped
 		QPointF              m_grabPos;
 		int                  m_fps;
 		bool                 m_animationsEnabled;
@@ -207,9 +360,37 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 		qreal                m_expandedWidth;
 		qreal                m_aspectRatio;
 		int                  m_expandDuration;
-		int                  m_timeStamp;
-
-		const static QTime   Midnight;
+		MonotonicAnimationClock m_monotonicClock;
+		AnimationClock      *m_animationClock;
+		qint64               m_timeStamp;
+		bool                 m_stableSizeHint;
+		QSizeF               m_reportedPreferredSize;
+		bool                 m_pixelSnapping;
+		int                  m_geometryUpdates;
+		int                  m_skippedGeometryUpdates;
+
+		// items in [m_dirtyBegin, m_dirtyEnd) changed since the last layout pass
+		int                  m_dirtyBegin;
+		int                  m_dirtyEnd;
+
+		// nesting depth of beginBatch()/commitBatch() and whether the
+		// layout has to be invalidated when the outermost batch ends
+		int                  m_batchDepth;
+		bool                 m_batchInvalidated;
+
+		// The parameters and rows of the last layout pass. The row buffers
+		// only grow, just their first m_rowInfoCount/m_newRowInfoCount
+		// entries are used.
+		QVector<RowInfo>     m_rowInfos;
+		int                  m_rowInfoCount;
+		QVector<RowInfo>     m_newRowInfos;
+		int                  m_newRowInfoCount;
+		int                  m_layoutRows;
+		qreal                m_layoutCellWidth;
+		qreal                m_layoutCellHeight;
+		qreal                m_layoutAvailableWidth;
+		QRectF               m_layoutRect;
+		bool                 m_layoutRtl;
 
 	protected:
 		QSizeF               m_preferredSize;
@@ -217,45 +398,5 @@ class TaskbarLayout : public QObject, public QGraphicsLayout {
 		int                  m_rows;
 };
 
-class TaskbarItem {
-	
-	public:
-		
-		TaskbarItem(
-			TaskItem *item,
-			qreal expansion,
-			ExpansionDirection direction,
-			int animation = TaskbarLayout::None)
-			: item(item), destX(0.0), destY(0.0),
-			  isNew(true), expansion(expansion),
-			  row(0), direction(direction),
-			  animation(animation) {}
-		~TaskbarItem();
-
-		TaskItem          *item;
-		qreal              destX;
-		qreal              destY;
-		bool               isNew;
-		qreal              expansion;
-		int                row;
-		ExpansionDirection direction;
-		int                animation;
-};
-
-class RowInfo {
-
-	public:
-		RowInfo(qreal preferredWidth, qreal minimumWidth, int startIndex, int endIndex)
-			: preferredWidth(preferredWidth),
-			  minimumWidth(minimumWidth),
-			  startIndex(startIndex),
-			  endIndex(endIndex) {}
-
-		qreal preferredWidth;
-		qreal minimumWidth;
-		int   startIndex;
-		int   endIndex;
-};
-
 } // namespace SmoothTasks
 #endif
@@ -20,19 +20,13 @@
 
 #include "SmoothTasks/ToggleAnimation.h"
 
-#include <Plasma/Animator>
+#include "SmoothTasks/AnimationDriver.h"
 
 namespace SmoothTasks {
 
-void ToggleAnimation::init() {
-	connect(
-		Plasma::Animator::self(), SIGNAL(customAnimationFinished(int)),
-		this, SLOT(finished(int)));
-}
-
 void ToggleAnimation::stop() {
 	if (m_animation) {
-		Plasma::Animator::self()->stopCustomAnimation(m_animation);
+		AnimationDriver::self()->stop(m_animation);
 		m_animation = 0;
 	}
 }
@@ -78,10 +72,8 @@ void ToggleAnimation::start(int fps, int duration, const char *animationSlot) {
 		emit finished(m_value);
 	}
 	else {
-		m_animation = Plasma::Animator::self()->customAnimation(
-			frames, duration,
-			Plasma::Animator::LinearCurve,
-			this, animationSlot);
+		m_animation = AnimationDriver::self()->start(
+			duration, fps, this, animationSlot, "finished");
 	}
 }
 
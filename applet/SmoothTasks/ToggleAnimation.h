@@ -39,7 +39,7 @@ public:
 		  m_value(0.0),
 		  m_oldValue(0.0),
 		  m_direction(Down),
-		  m_finished(false) { init(); }
+		  m_finished(false) {}
 
 	ToggleAnimation()
 		: QObject(),
@@ -47,7 +47,7 @@ public:
 		  m_value(0.0),
 		  m_oldValue(0.0),
 		  m_direction(Down),
-		  m_finished(false) { init(); }
+		  m_finished(false) {}
 
 	~ToggleAnimation() { stop(); }
 
@@ -72,7 +72,6 @@ private slots:
 	void finished(int animation);
 
 private:
-	void init();
 	void start(int fps, int duration, const char *animationSlot);
 
 	int       m_animation;
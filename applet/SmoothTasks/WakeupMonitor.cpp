@@ -0,0 +1,163 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "SmoothTasks/WakeupMonitor.h"
+
+#include <QStringList>
+#include <QTimer>
+
+#include <cstring>
+
+namespace SmoothTasks {
+
+WakeupMonitor *WakeupMonitor::self() {
+	// shared by all applets of the process and never deleted
+	static WakeupMonitor *monitor = NULL;
+
+	if (monitor == NULL) {
+		monitor = new WakeupMonitor();
+	}
+
+	return monitor;
+}
+
+WakeupMonitor::WakeupMonitor()
+		: QObject(),
+		  m_clock(),
+		  m_secondStart(0),
+		  m_timers(),
+		  m_sources(),
+		  m_current(),
+		  m_last(),
+		  m_totals() {
+}
+
+void WakeupMonitor::watch(QTimer *timer, const char *source) {
+	if (timer == NULL || source == NULL) {
+		qWarning("WakeupMonitor::watch: timer and source are required");
+		return;
+	}
+
+	if (!m_timers.contains(timer)) {
+		connect(timer, SIGNAL(timeout()), this, SLOT(timerFired()));
+		connect(timer, SIGNAL(destroyed(QObject*)), this, SLOT(timerDestroyed(QObject*)));
+	}
+	m_timers.insert(timer, source);
+}
+
+void WakeupMonitor::timerFired() {
+	const char *source = m_timers.value(sender(), NULL);
+
+	if (source != NULL) {
+		count(source);
+	}
+}
+
+void WakeupMonitor::timerDestroyed(QObject *timer) {
+	m_timers.remove(timer);
+}
+
+int WakeupMonitor::indexOf(const char *source) const {
+	const int N = m_sources.size();
+
+	for (int index = 0; index < N; ++ index) {
+		if (m_sources[index] == source || std::strcmp(m_sources[index], source) == 0) {
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+void WakeupMonitor::closeSecond(qint64 now) {
+	// a second without any wakeups in between counts nothing
+	const bool follows = now - m_secondStart < 2000;
+	const int  N       = m_sources.size();
+	bool       any     = false;
+
+	for (int index = 0; index < N; ++ index) {
+		m_last[index]    = follows ? m_current[index] : 0;
+		m_current[index] = 0;
+		any = any || m_last[index] > 0;
+	}
+
+	m_secondStart = now;
+
+	if (any) {
+		emit secondEnded();
+	}
+}
+
+void WakeupMonitor::count(const char *source) {
+	const qint64 now = m_clock.now();
+
+	if (now - m_secondStart >= 1000) {
+		closeSecond(now);
+	}
+
+	int index = indexOf(source);
+
+	if (index == -1) {
+		index = m_sources.size();
+		m_sources.append(source);
+		m_current.append(0);
+		m_last.append(0);
+		m_totals.append(0);
+	}
+
+	++ m_current[index];
+	++ m_totals[index];
+}
+
+QString WakeupMonitor::lastSecond() const {
+	QStringList counts;
+	const int   N = m_sources.size();
+
+	for (int index = 0; index < N; ++ index) {
+		if (m_last[index] > 0) {
+			counts.append(QString("%1: %2").arg(m_sources[index]).arg(m_last[index]));
+		}
+	}
+
+	return counts.join(", ");
+}
+
+int WakeupMonitor::lastSecond(const char *source) const {
+	const int index = indexOf(source);
+	return index == -1 ? 0 : m_last[index];
+}
+
+qint64 WakeupMonitor::total(const char *source) const {
+	const int index = indexOf(source);
+	return index == -1 ? 0 : m_totals[index];
+}
+
+qint64 WakeupMonitor::total() const {
+	qint64 total = 0;
+
+	foreach (qint64 sourceTotal, m_totals) {
+		total += sourceTotal;
+	}
+
+	return total;
+}
+
+} // namespace SmoothTasks
+#include "WakeupMonitor.moc"
@@ -0,0 +1,82 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+#ifndef SMOOTHTASKS_WAKEUPMONITOR_H
+#define SMOOTHTASKS_WAKEUPMONITOR_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "SmoothTasks/AnimationClock.h"
+
+class QTimer;
+
+namespace SmoothTasks {
+
+// Counts how often the timers of the applet fire, per source and second.
+// The monitor has no timer of its own: a second is closed by the first
+// wakeup after it, so an idle applet stays idle and reports nothing.
+class WakeupMonitor : public QObject {
+	Q_OBJECT
+
+public:
+	static WakeupMonitor *self();
+
+	// Counts every timeout() of the timer as a wakeup of the source. The
+	// source has to be a string literal.
+	void watch(QTimer *timer, const char *source);
+	void count(const char *source);
+
+	// wakeups per source in the last second that had any, like
+	// "AnimationDriver: 25, SmoothToolTip: 3"
+	QString lastSecond() const;
+	int     lastSecond(const char *source) const;
+	qint64  total(const char *source) const;
+	// of all sources
+	qint64  total() const;
+
+signals:
+	// a second with wakeups ended, lastSecond() returns its counts
+	void secondEnded();
+
+private slots:
+	void timerFired();
+	void timerDestroyed(QObject *timer);
+
+private:
+	WakeupMonitor();
+
+	int  indexOf(const char *source) const;
+	void closeSecond(qint64 now);
+
+	MonotonicAnimationClock   m_clock;
+	qint64                    m_secondStart;
+	QHash<QObject*, const char*> m_timers;
+
+	// the sources as parallel arrays
+	QVector<const char*>      m_sources;
+	QVector<int>              m_current;
+	QVector<int>              m_last;
+	QVector<qint64>           m_totals;
+};
+
+} // namespace SmoothTasks
+#endif
@@ -24,6 +24,7 @@
 #include "SmoothTasks/CloseIcon.h"
 #include "SmoothTasks/Task.h"
 #include "SmoothTasks/Global.h"
+#include "SmoothTasks/WakeupMonitor.h"
 
 // Qt
 #include <QFontInfo>
@@ -35,7 +36,6 @@
 #include <KIcon>
 #include <KIconEffect>
 #include <KWindowSystem>
-#include <Plasma/PaintUtils>
 
 // taskmanager
 #include <taskmanager/taskmanager.h>
@@ -59,9 +59,14 @@ WindowPreview::WindowPreview(
 	  m_iconSpace(NULL),
 	  m_previewSpace(NULL),
 	  m_highlite(),
+	  m_backgroundFade(),
+	  m_iconFade(),
 	  m_task(new Task(task, this)),
 	  m_toolTip(toolTip),
 	  m_previewSize(0, 0),
+	  m_icon(),
+	  m_hoverIcon(),
+	  m_hoverIconKey(0),
 	  m_hover(false),
 	  m_index(index),
 	  m_activateTimer(NULL),
@@ -360,10 +365,15 @@ void WindowPreview::closeTask() {
 QPixmap WindowPreview::hoverIcon() const {
 	KIconEffect *effect = KIconLoader::global()->iconEffect();
 	if (effect->hasEffect(KIconLoader::Desktop, KIconLoader::ActiveState)) {
-		return effect->apply(
-			m_icon,
-			KIconLoader::Desktop,
-			KIconLoader::ActiveState);
+		// the effect is applied on an image, so only do it once per icon
+		if (m_hoverIconKey != m_icon.cacheKey()) {
+			m_hoverIcon = effect->apply(
+				m_icon,
+				KIconLoader::Desktop,
+				KIconLoader::ActiveState);
+			m_hoverIconKey = m_icon.cacheKey();
+		}
+		return m_hoverIcon;
 	}
 	else {
 		return m_icon;
@@ -376,34 +386,32 @@ void WindowPreview::paintEvent(QPaintEvent *event) {
 
 	// draw background (only when previews are used)
 	if (m_previewSpace) {
-		QPixmap  backgroundPixmap;
 		qreal    normalLeft = 0, normalTop = 0, normalRight = 0, normalBottom = 0;
 
 		// caching of the pixmap is done by the class FrameSvg
 		m_background->setElementPrefix(NORMAL);
 		m_background->getMargins(normalLeft, normalTop, normalRight, normalBottom);
 
+		QRect  spaceGeom(m_previewSpace->geometry());
+		QPoint backgroundPos(
+			spaceGeom.left() + (spaceGeom.width()  - m_previewSize.width())  / 2 - normalLeft,
+			spaceGeom.top()  + (spaceGeom.height() - m_previewSize.height()) / 2 - normalTop);
+
 		if (m_highlite.atBottom()) {
-			backgroundPixmap = m_background->framePixmap();
+			painter.drawPixmap(backgroundPos, m_background->framePixmap());
 		}
 		else if (m_highlite.atTop()) {
 			m_background->setElementPrefix(HOVER);
-			backgroundPixmap = m_background->framePixmap();
+			painter.drawPixmap(backgroundPos, m_background->framePixmap());
 		}
 		else {
-			QPixmap normal(m_background->framePixmap());
-	
+			m_backgroundFade.addLayer(m_background->framePixmap());
+
 			m_background->setElementPrefix(HOVER);
-			QPixmap hover(m_background->framePixmap());
-				
-			backgroundPixmap = Plasma::PaintUtils::transition(normal, hover, m_highlite.value());
-		}
-		QRect  spaceGeom(m_previewSpace->geometry());
-		QPoint backgroundPos(
-			spaceGeom.left() + (spaceGeom.width()  - m_previewSize.width())  / 2 - normalLeft,
-			spaceGeom.top()  + (spaceGeom.height() - m_previewSize.height()) / 2 - normalTop);
+			m_backgroundFade.addLayer(m_background->framePixmap(), m_highlite.value());
 
-		painter.drawPixmap(backgroundPos, backgroundPixmap);
+			painter.drawImage(backgroundPos, m_backgroundFade.render());
+		}
 		
 		// draw icon as fake preview for startup items
 		if (m_task->type() == Task::StartupItem) {
@@ -412,22 +420,22 @@ void WindowPreview::paintEvent(QPaintEvent *event) {
 	}
 	
 	// draw icon
-	QPixmap  iconPixmap;
 	QRect    iconGeom(m_iconSpace->geometry());
 	QPointF  iconPos(
 		iconGeom.left() + (iconGeom.width()  - m_icon.width())  * 0.5,
 		iconGeom.top()  + (iconGeom.height() - m_icon.height()) * 0.5);
 
 	if (m_highlite.atBottom()) {
-		iconPixmap = m_icon;
+		painter.drawPixmap(iconPos, m_icon);
 	}
 	else if (m_highlite.atTop()) {
-		iconPixmap = hoverIcon();
+		painter.drawPixmap(iconPos, hoverIcon());
 	}
 	else {
-		iconPixmap = Plasma::PaintUtils::transition(m_icon, hoverIcon(), m_highlite.value());
+		m_iconFade.addLayer(m_icon);
+		m_iconFade.addLayer(hoverIcon(), m_highlite.value());
+		painter.drawImage(iconPos, m_iconFade.render());
 	}
-	painter.drawPixmap(iconPos, iconPixmap);
 }
 
 void WindowPreview::enterEvent(QEvent *event) {
@@ -519,6 +527,7 @@ void WindowPreview::dragEnterEvent(QDragEnterEvent *event) {
 		m_activateTimer->setSingleShot(true);
 		m_activateTimer->setInterval(DRAG_HOVER_DELAY);
 		connect(m_activateTimer, SIGNAL(timeout()), this, SLOT(activateForDrop()));
+		WakeupMonitor::self()->watch(m_activateTimer, "WindowPreview");
 	}
 	m_activateTimer->start();
 	event->ignore();
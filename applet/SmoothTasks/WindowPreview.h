@@ -26,6 +26,7 @@
 #include "SmoothTasks/SmoothToolTip.h"
 #include "SmoothTasks/FadedText.h"
 #include "SmoothTasks/ToggleAnimation.h"
+#include "SmoothTasks/CrossFade.h"
 
 #include <QWidget>
 #include <QSize>
@@ -96,10 +97,14 @@ class WindowPreview : public QWidget {
 		QSpacerItem           *m_iconSpace;
 		QSpacerItem           *m_previewSpace;
 		ToggleAnimation        m_highlite;
+		CrossFade              m_backgroundFade;
+		CrossFade              m_iconFade;
 		Task                  *m_task;
 		SmoothToolTip         *m_toolTip;
 		QSize                  m_previewSize;
 		QPixmap                m_icon;
+		mutable QPixmap        m_hoverIcon;    // made from the m_icon with
+		mutable qint64         m_hoverIconKey; // this QPixmap::cacheKey()
 		bool                   m_hover;
 		int                    m_index;
 		QTimer                *m_activateTimer;
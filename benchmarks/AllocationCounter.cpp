@@ -0,0 +1,90 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "AllocationCounter.h"
+
+// STD C++
+// (only headers that don't declare malloc() and friends, but define __GLIBC__)
+#include <climits>
+#include <cstddef>
+
+namespace {
+
+unsigned long g_allocations = 0;
+int           g_suspended   = 0;
+
+inline void countAllocation() {
+	if (g_suspended == 0) {
+		++ g_allocations;
+	}
+}
+
+} // anonymous namespace
+
+#if defined(__GLIBC__)
+// Qt allocates its containers with malloc() and operator new ends up there too,
+// so interposing the allocator functions of glibc catches every allocation.
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+	countAllocation();
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	countAllocation();
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+	countAllocation();
+	return __libc_realloc(ptr, size);
+}
+
+} // extern "C"
+#endif
+
+namespace SmoothTasks {
+
+bool AllocationCounter::isSupported() {
+#if defined(__GLIBC__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+unsigned long AllocationCounter::count() {
+	return g_allocations;
+}
+
+void AllocationCounter::suspend() {
+	++ g_suspended;
+}
+
+void AllocationCounter::resume() {
+	-- g_suspended;
+}
+
+} // namespace SmoothTasks
@@ -0,0 +1,330 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Headless benchmark for the CrossFade kernels.
+//
+// The layers of typical state transitions are cross-faded the way the applet
+// did it before, with one Plasma::PaintUtils::transition() per layer, and with
+// every blend kernel of CrossFade. PaintUtils needs pixmaps and so an X server,
+// the reference therefore does the same composition on images:
+//
+//   reference   one transition per layer, each with new images
+//   scalar      CrossFade::blendScalar()
+//   sse2        CrossFade::blendSse2()
+//   avx2        CrossFade::blendAvx2(), only if the processor has AVX2
+//   render      CrossFade::addLayer() and render() like the applet calls it
+//
+// Every kernel also is compared to the reference. The benchmark fails if a
+// channel differs by more than the rounding of the reference allows.
+//
+// The output is tab separated so runs can be diffed or fed into a spreadsheet:
+//
+//   smooth-tasks-crossfadebench --min-time 500
+
+// Smooth Tasks
+#include "SmoothTasks/CrossFade.h"
+
+// Qt
+#include <QApplication>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QStringList>
+
+// STD C++
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SmoothTasks;
+
+namespace {
+
+// the reference rounds the amount to 8 bits and every transition once more
+const int TOLERANCE = 3;
+
+struct Size {
+	int         width;
+	int         height;
+	const char *name;
+};
+
+const Size SIZES[] = {
+	{  48,  48, "icon" },
+	{ 200,  58, "frame" },
+	{ 260, 200, "preview" }
+};
+
+const int SIZES_SIZE = sizeof(SIZES) / sizeof(SIZES[0]);
+
+// the amounts of the layers above the first one, like a task that is faded
+// from minimized over focused and attention to hovered
+const qreal AMOUNTS[] = { 0.8, 0.45, 0.3, 0.65 };
+
+const int MIN_LAYERS = 2;
+const int MAX_LAYERS = 5;
+
+typedef void (*Kernel)(quint32 *target, const quint32 * const *layers, const int *weights, int layerCount, int length);
+
+struct Fixture {
+	QList<QImage> layers;
+	QImage        target;
+};
+
+// A premultiplied image with a gradient in every channel and some noise, so
+// no two layers are alike.
+QImage createLayer(const Size& size) {
+	QImage image(size.width, size.height, QImage::Format_ARGB32_Premultiplied);
+	const int phase = qrand() % 256;
+
+	for (int y = 0; y < size.height; ++ y) {
+		QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+		for (int x = 0; x < size.width; ++ x) {
+			const int alpha = (phase + x * 255 / size.width + qrand() % 32) % 256;
+			line[x] = qRgba(
+				(x * 7 + phase) % 256 * alpha / 255,
+				(y * 5 + phase) % 256 * alpha / 255,
+				qrand() % 256 * alpha / 255,
+				alpha);
+		}
+	}
+
+	return image;
+}
+
+// Plasma::PaintUtils::transition() of kdelibs 4, on images.
+QImage transition(const QImage& from, const QImage& to, qreal amount) {
+	QImage start(from);
+	QImage target(to);
+	QColor color;
+	color.setAlphaF(amount);
+
+	// start and target are copies, so painting on them detaches
+	QPainter painter(&start);
+	painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
+	painter.fillRect(start.rect(), color);
+	painter.end();
+
+	painter.begin(&target);
+	painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+	painter.fillRect(target.rect(), color);
+	painter.end();
+
+	painter.begin(&start);
+	painter.setCompositionMode(QPainter::CompositionMode_Plus);
+	painter.drawImage(0, 0, target);
+	painter.end();
+
+	return start;
+}
+
+QImage reference(const Fixture& fixture) {
+	QImage result(fixture.layers[0]);
+
+	for (int layer = 1; layer < fixture.layers.size(); ++ layer) {
+		result = transition(result, fixture.layers[layer], AMOUNTS[layer - 1]);
+	}
+
+	return result;
+}
+
+void blendWith(Kernel kernel, Fixture& fixture) {
+	const int layerCount = fixture.layers.size();
+	const quint32 *layers[CrossFade::MAX_LAYERS];
+	int weights[CrossFade::MAX_LAYERS];
+
+	weights[0] = 256;
+	for (int layer = 1; layer < layerCount; ++ layer) {
+		weights[layer] = qRound(AMOUNTS[layer - 1] * 256);
+	}
+
+	for (int y = 0; y < fixture.target.height(); ++ y) {
+		for (int layer = 0; layer < layerCount; ++ layer) {
+			layers[layer] = reinterpret_cast<const quint32*>(fixture.layers[layer].constScanLine(y));
+		}
+
+		kernel(reinterpret_cast<quint32*>(fixture.target.scanLine(y)),
+			layers, weights, layerCount, fixture.target.width());
+	}
+}
+
+// returns the largest difference of a channel
+int maxDifference(const QImage& a, const QImage& b) {
+	int result = 0;
+
+	for (int y = 0; y < a.height(); ++ y) {
+		const QRgb *lineA = reinterpret_cast<const QRgb*>(a.constScanLine(y));
+		const QRgb *lineB = reinterpret_cast<const QRgb*>(b.constScanLine(y));
+
+		for (int x = 0; x < a.width(); ++ x) {
+			for (int shift = 0; shift < 32; shift += 8) {
+				const int difference = std::abs(int((lineA[x] >> shift) & 0xff) - int((lineB[x] >> shift) & 0xff));
+				result = qMax(result, difference);
+			}
+		}
+	}
+
+	return result;
+}
+
+// returns microseconds per call
+template<typename Operation>
+double measure(Operation operation, int minTime, int& iterations) {
+	QElapsedTimer timer;
+	iterations = 0;
+	timer.start();
+
+	do {
+		operation();
+		++ iterations;
+	} while (timer.elapsed() < minTime);
+
+	return timer.elapsed() * 1000.0 / iterations;
+}
+
+struct ReferenceOperation {
+	const Fixture& fixture;
+	ReferenceOperation(const Fixture& fixture) : fixture(fixture) {}
+	void operator () () const { reference(fixture); }
+};
+
+struct KernelOperation {
+	Kernel   kernel;
+	Fixture& fixture;
+	KernelOperation(Kernel kernel, Fixture& fixture) : kernel(kernel), fixture(fixture) {}
+	void operator () () const { blendWith(kernel, fixture); }
+};
+
+struct RenderOperation {
+	CrossFade&     fade;
+	const Fixture& fixture;
+	RenderOperation(CrossFade& fade, const Fixture& fixture) : fade(fade), fixture(fixture) {}
+	void operator () () const {
+		fade.addLayer(fixture.layers[0]);
+		for (int layer = 1; layer < fixture.layers.size(); ++ layer) {
+			fade.addLayer(fixture.layers[layer], AMOUNTS[layer - 1]);
+		}
+		fade.render();
+	}
+};
+
+void printRow(const Size& size, int layerCount, const char *kernel, int iterations, double usec) {
+	std::printf("%s\t%d\t%s\t%d\t%.2f\n", size.name, layerCount, kernel, iterations, usec);
+	std::fflush(stdout);
+}
+
+// returns false if a kernel differs too much from the reference
+bool run(const Size& size, int layerCount, int minTime) {
+	Fixture fixture;
+	for (int layer = 0; layer < layerCount; ++ layer) {
+		fixture.layers.append(createLayer(size));
+	}
+	fixture.target = QImage(size.width, size.height, QImage::Format_ARGB32_Premultiplied);
+
+	const QImage expected(reference(fixture));
+	int  iterations = 0;
+	bool ok         = true;
+
+	const double referenceUsec = measure(ReferenceOperation(fixture), minTime, iterations);
+	printRow(size, layerCount, "reference", iterations, referenceUsec);
+
+	struct { Kernel kernel; const char *name; } kernels[] = {
+		{ CrossFade::blendScalar, "scalar" },
+#ifdef __SSE2__
+		{ CrossFade::blendSse2,   "sse2" },
+#endif
+#ifdef SMOOTHTASKS_CROSSFADE_AVX2
+		{ CrossFade::hasAvx2() ? CrossFade::blendAvx2 : NULL, "avx2" },
+#endif
+	};
+
+	for (size_t index = 0; index < sizeof(kernels) / sizeof(kernels[0]); ++ index) {
+		if (kernels[index].kernel == NULL) {
+			continue;
+		}
+
+		const double usec = measure(KernelOperation(kernels[index].kernel, fixture), minTime, iterations);
+		printRow(size, layerCount, kernels[index].name, iterations, usec);
+
+		const int difference = maxDifference(expected, fixture.target);
+		if (difference > TOLERANCE) {
+			std::fprintf(stderr, "%s, %d layers: %s differs from the reference by %d\n",
+				size.name, layerCount, kernels[index].name, difference);
+			ok = false;
+		}
+	}
+
+	CrossFade fade;
+	const double usec = measure(RenderOperation(fade, fixture), minTime, iterations);
+	printRow(size, layerCount, "render", iterations, usec);
+
+	return ok;
+}
+
+void usage(const char *argv0) {
+	std::fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --min-time MSECS   time spent per measurement (default: 200)\n",
+		argv0);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+	// no GUI: only images are painted, so no X server is needed
+	QApplication app(argc, argv, false);
+	QStringList  args(app.arguments());
+	int          minTime = 200;
+
+	for (int index = 1; index < args.size(); ++ index) {
+		const QString& arg = args[index];
+		bool ok = true;
+
+		if (arg == "--min-time" && index + 1 < args.size()) {
+			minTime = args[++ index].toInt(&ok);
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// always the same layers, so runs can be compared
+	qsrand(1);
+
+	std::printf("# blend() uses the %s kernel\n", CrossFade::kernelName());
+	std::printf("# size\tlayers\tkernel\titerations\tusec/op\n");
+
+	bool ok = true;
+	for (int size = 0; size < SIZES_SIZE; ++ size) {
+		for (int layerCount = MIN_LAYERS; layerCount <= MAX_LAYERS; ++ layerCount) {
+			if (!run(SIZES[size], layerCount, minTime)) {
+				ok = false;
+			}
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,772 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Headless benchmark for the TaskbarLayout strategies.
+//
+// Every layout is filled with synthetic items and the cost of the operations
+// that run while the user works with the taskbar is measured:
+//
+//   doLayout         a full layout pass (TaskbarLayout::setGeometry)
+//   expandAt         requesting an expansion or collapse of one item
+//   moveDraggedItem  one drag move event of a drag and drop reordering
+//   itemAt           hit-testing a point (TaskbarLayout::itemAt(QPointF))
+//   animate          one animation tick including the resulting relayout,
+//                    timed by a virtual clock that advances one frame per tick
+//   reload           removing and re-adding all items in one batch like
+//                    Applet::reloadItems(), with one index lookup per item
+//
+// The output is tab separated so runs can be diffed or fed into a spreadsheet.
+// No X server or Plasma is needed, run e.g.:
+//
+//   smooth-tasks-layoutbench --layout LimitSqueeze --max-items 1000
+//
+// With --check-allocations nothing is timed. Instead the heap allocations of
+// layout passes in steady state are counted and the benchmark fails if there
+// are any:
+//
+//   doLayout         a layout pass without changes
+//   relayout         a layout pass that has to lay out all rows again
+//
+// With --check-rows nothing is timed either. LimitSqueezeTaskbarLayout is run on
+// randomized items and geometries and its rows are compared to those of the
+// item by item algorithm it replaced (LimitSqueezeReference).
+//
+// With --check-capacity nothing is timed. LimitSqueezeTaskbarLayout and the
+// CapacityController of the applet are run in a loop with a simulated "only
+// group when full" group manager on randomized tasks and geometries. The check
+// fails if the tasks are regrouped more than once, i.e. if the layout keeps
+// proposing N-1 and N+10 in turn and the flips go through once the minimum
+// dwell time has passed.
+//
+// With --count-geometry nothing is timed. The geometries the layout sets on
+// the items per pass are counted, along with those skipped because the item
+// already was there, for doLayout, relayout and animate. Add --pixel-snapping
+// to count them with the destinations snapped to whole pixels.
+//
+// With --all-directions every layout is measured horizontal and vertical, each
+// left-to-right and right-to-left, and the rows are labelled like
+// "ByShape/vertical-rtl".
+
+// Smooth Tasks
+#include "AllocationCounter.h"
+#include "SmoothTasks/CapacityController.h"
+#include "LimitSqueezeReference.h"
+#include "VirtualClock.h"
+#include "SmoothTasks/TaskItem.h"
+#include "SmoothTasks/ByShapeTaskbarLayout.h"
+#include "SmoothTasks/MaxSqueezeTaskbarLayout.h"
+#include "SmoothTasks/FixedItemCountTaskbarLayout.h"
+#include "SmoothTasks/FixedSizeTaskbarLayout.h"
+#include "SmoothTasks/LimitSqueezeTaskbarLayout.h"
+
+// Qt
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QGraphicsWidget>
+#include <QStringList>
+
+// STD C++
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SmoothTasks;
+
+namespace {
+
+const int ITEM_COUNTS[] = { 1, 10, 50, 100, 200, 500, 1000, 2000, 5000 };
+
+const int ITEM_COUNTS_SIZE = sizeof(ITEM_COUNTS) / sizeof(ITEM_COUNTS[0]);
+
+struct LayoutName {
+	TaskbarLayout::TaskbarLayoutType type;
+	const char                      *name;
+};
+
+const LayoutName LAYOUTS[] = {
+	{ TaskbarLayout::ByShape,        "ByShape" },
+	{ TaskbarLayout::MaxSqueeze,     "MaxSqueeze" },
+	{ TaskbarLayout::FixedItemCount, "FixedItemCount" },
+	{ TaskbarLayout::FixedSize,      "FixedSize" },
+	{ TaskbarLayout::LimitSqueeze,   "LimitSqueeze" }
+};
+
+const int LAYOUTS_SIZE = sizeof(LAYOUTS) / sizeof(LAYOUTS[0]);
+
+struct Direction {
+	Qt::Orientation     orientation;
+	Qt::LayoutDirection layoutDirection;
+	const char         *name;
+};
+
+const Direction DIRECTIONS[] = {
+	{ Qt::Horizontal, Qt::LeftToRight, "horizontal" },
+	{ Qt::Horizontal, Qt::RightToLeft, "horizontal-rtl" },
+	{ Qt::Vertical,   Qt::LeftToRight, "vertical" },
+	{ Qt::Vertical,   Qt::RightToLeft, "vertical-rtl" }
+};
+
+const int DIRECTIONS_SIZE = sizeof(DIRECTIONS) / sizeof(DIRECTIONS[0]);
+
+struct Options {
+	Options()
+		: layouts(),
+		  maxItems(5000),
+		  minTime(200),
+		  orientation(Qt::Horizontal),
+		  layoutDirection(Qt::LeftToRight),
+		  allDirections(false),
+		  checkAllocations(false),
+		  checkRows(false),
+		  checkCapacity(false),
+		  countGeometry(false),
+		  pixelSnapping(false) {}
+
+	QStringList         layouts;
+	int                 maxItems;
+	int                 minTime; // milliseconds spent per measurement
+	Qt::Orientation     orientation;
+	Qt::LayoutDirection layoutDirection;
+	bool                allDirections;
+	bool                checkAllocations;
+	bool                checkRows;
+	bool                checkCapacity;
+	bool                countGeometry;
+	bool                pixelSnapping;
+};
+
+// one layout in one direction
+struct Case {
+	TaskbarLayout::TaskbarLayoutType type;
+	Qt::Orientation                  orientation;
+	Qt::LayoutDirection              layoutDirection;
+	QByteArray                       label;
+};
+
+// Uses the same defaults as Applet::configuration().
+TaskbarLayout *createLayout(TaskbarLayout::TaskbarLayoutType type, Qt::Orientation orientation) {
+	switch (type) {
+	case TaskbarLayout::ByShape:
+		return new ByShapeTaskbarLayout(1.5, orientation);
+	case TaskbarLayout::MaxSqueeze:
+		return new MaxSqueezeTaskbarLayout(orientation);
+	case TaskbarLayout::FixedItemCount:
+		return new FixedItemCountTaskbarLayout(14, orientation);
+	case TaskbarLayout::FixedSize:
+		return new FixedSizeTaskbarLayout(40, orientation);
+	case TaskbarLayout::LimitSqueeze:
+	default:
+		return new LimitSqueezeTaskbarLayout(0.6, false, orientation);
+	}
+}
+
+class Fixture {
+
+public:
+	Fixture(TaskbarLayout::TaskbarLayoutType type, Qt::Orientation orientation, int itemCount)
+			: clock(),
+			  host(new QGraphicsWidget()),
+			  layout(createLayout(type, orientation)),
+			  items() {
+		layout->setContentsMargins(0, 0, 0, 0);
+		layout->setSpacing(5);
+		layout->setRowBounds(1, 3);
+		layout->setAspectRatio(1.2);
+		layout->setExpandedWidth(175);
+		layout->setExpandDuration(175);
+		layout->setFps(25);
+		layout->setAnimationClock(&clock);
+		host->setLayout(layout);
+
+		if (orientation == Qt::Vertical) {
+			host->resize(58, 1000);
+		}
+		else {
+			host->resize(1600, 58);
+		}
+
+		for (int index = 0; index < itemCount; ++ index) {
+			// every 7th item is a group, like a typical "group when full" taskbar
+			TaskItem *item = index % 7 == 6 ?
+				new TaskItem(Task::GroupItem, 3, host) :
+				new TaskItem(Task::TaskItem, 1, host);
+			items.append(item);
+			layout->addItem(item, false);
+		}
+
+		settle();
+		geometry = layout->geometry();
+	}
+
+	~Fixture() {
+		// deletes the layout and the items
+		delete host;
+	}
+
+	// process pending layout requests like the event loop of the applet would
+	void settle() {
+		QApplication::sendPostedEvents(host, QEvent::LayoutRequest);
+		layout->activate();
+	}
+
+	// a point that wanders over all the rows of the taskbar
+	QPointF sweepPoint(int step) const {
+		const QRectF rect(layout->geometry());
+		const bool   isVertical = layout->orientation() == Qt::Vertical;
+		const qreal  length     = isVertical ? rect.height() : rect.width();
+		const qreal  thickness  = isVertical ? rect.width()  : rect.height();
+		const int    rows       = qMax(1, layout->rows());
+		const qreal  along      = std::fmod(step * 7.0, qMax(length, qreal(1.0)));
+		const qreal  across     = thickness * ((step / 64) % rows + 0.5) / rows;
+
+		return isVertical ?
+			QPointF(rect.left() + across, rect.top() + along) :
+			QPointF(rect.left() + along,  rect.top() + across);
+	}
+
+	VirtualClock      clock;
+	QGraphicsWidget  *host;
+	TaskbarLayout    *layout;
+	QList<TaskItem*>  items;
+	QRectF            geometry;
+};
+
+typedef void (*Operation)(Fixture& fixture, int iteration);
+
+void doLayout(Fixture& fixture, int iteration) {
+	Q_UNUSED(iteration);
+	fixture.layout->setGeometry(fixture.layout->geometry());
+}
+
+void relayout(Fixture& fixture, int iteration) {
+	// alternate between two row lengths so every row has to be layed out again
+	QRectF rect(fixture.geometry);
+
+	if (iteration & 1) {
+		if (fixture.layout->orientation() == Qt::Vertical) {
+			rect.setHeight(rect.height() - 1);
+		}
+		else {
+			rect.setWidth(rect.width() - 1);
+		}
+	}
+
+	fixture.layout->setGeometry(rect);
+}
+
+void expandAt(Fixture& fixture, int iteration) {
+	const int index = (iteration / 2) % fixture.items.size();
+	fixture.layout->expandAt(index, iteration & 1 ? Collapse : Expand);
+}
+
+void moveDraggedItem(Fixture& fixture, int iteration) {
+	fixture.layout->moveDraggedItem(fixture.sweepPoint(iteration));
+}
+
+void itemAt(Fixture& fixture, int iteration) {
+	fixture.layout->itemAt(fixture.sweepPoint(iteration));
+}
+
+void animate(Fixture& fixture, int iteration) {
+	// hover in and out of an item so there always is something to animate
+	if (iteration % 8 == 0) {
+		const int index = (iteration / 16) % fixture.items.size();
+		fixture.layout->expandAt(index, (iteration / 8) & 1 ? Collapse : Expand);
+	}
+	fixture.clock.advance(1000 / fixture.layout->fps());
+	QMetaObject::invokeMethod(fixture.layout, "animate");
+	fixture.settle();
+}
+
+void reload(Fixture& fixture, int iteration) {
+	Q_UNUSED(iteration);
+	TaskbarLayout *layout = fixture.layout;
+
+	layout->beginBatch();
+	layout->clear();
+
+	foreach (TaskItem *item, fixture.items) {
+		layout->insertItem(layout->count(), item, false);
+	}
+
+	layout->commitBatch();
+	layout->optimumCapacity();
+	layout->activate();
+
+	// like hovering every item once: expandItem() looks up the index
+	foreach (TaskItem *item, fixture.items) {
+		layout->indexOf(item);
+	}
+
+	fixture.settle();
+}
+
+// returns microseconds per call
+double measure(Fixture& fixture, Operation operation, int minTime, int& iterations) {
+	QElapsedTimer timer;
+	iterations = 0;
+	timer.start();
+
+	do {
+		operation(fixture, iterations);
+		++ iterations;
+	} while (timer.elapsed() < minTime);
+
+	return timer.elapsed() * 1000.0 / iterations;
+}
+
+// returns the number of allocations of a number of calls after warming up
+unsigned long countAllocations(Fixture& fixture, Operation operation) {
+	const int WARMUP = 4;
+	const int RUNS   = 64;
+
+	for (int iteration = 0; iteration < WARMUP; ++ iteration) {
+		operation(fixture, iteration);
+	}
+
+	const unsigned long before = AllocationCounter::count();
+
+	for (int iteration = WARMUP; iteration < WARMUP + RUNS; ++ iteration) {
+		operation(fixture, iteration);
+	}
+
+	return AllocationCounter::count() - before;
+}
+
+// returns false if a steady state layout pass allocated memory
+bool checkAllocations(const Case& layoutCase, int itemCount) {
+	Fixture fixture(layoutCase.type, layoutCase.orientation, itemCount);
+
+	const unsigned long layoutAllocations   = countAllocations(fixture, doLayout);
+	const unsigned long relayoutAllocations = countAllocations(fixture, relayout);
+
+	std::printf("%s\t%d\tdoLayout\t%lu\n", layoutCase.label.constData(), itemCount, layoutAllocations);
+	std::printf("%s\t%d\trelayout\t%lu\n", layoutCase.label.constData(), itemCount, relayoutAllocations);
+	std::fflush(stdout);
+
+	return layoutAllocations == 0 && relayoutAllocations == 0;
+}
+
+// prints the geometries set and skipped per call after warming up
+void countGeometry(Fixture& fixture, const char *name, int itemCount, const char *operationName, Operation operation) {
+	const int WARMUP = 4;
+	const int RUNS   = 64;
+
+	for (int iteration = 0; iteration < WARMUP; ++ iteration) {
+		operation(fixture, iteration);
+	}
+
+	fixture.layout->resetGeometryCounters();
+
+	for (int iteration = WARMUP; iteration < WARMUP + RUNS; ++ iteration) {
+		operation(fixture, iteration);
+	}
+
+	std::printf("%s\t%d\t%s\t%.1f\t%.1f\n", name, itemCount, operationName,
+		fixture.layout->geometryUpdates() / (double) RUNS,
+		fixture.layout->skippedGeometryUpdates() / (double) RUNS);
+	std::fflush(stdout);
+}
+
+void countGeometry(const Case& layoutCase, int itemCount, const Options& options) {
+	Fixture fixture(layoutCase.type, layoutCase.orientation, itemCount);
+	const char *name = layoutCase.label.constData();
+
+	fixture.layout->setPixelSnapping(options.pixelSnapping);
+	fixture.settle();
+
+	countGeometry(fixture, name, itemCount, "doLayout", doLayout);
+	countGeometry(fixture, name, itemCount, "relayout", relayout);
+	countGeometry(fixture, name, itemCount, "animate",  animate);
+}
+
+qreal randomReal(qreal min, qreal max) {
+	return min + (max - min) * qrand() / RAND_MAX;
+}
+
+int randomInt(int min, int max) {
+	return min + qrand() % (max - min + 1);
+}
+
+// returns false if the rows of a randomized LimitSqueeze layout differ from
+// those of the reference algorithm
+bool checkRows(int testCase) {
+	const Qt::Orientation orientation = qrand() & 1 ? Qt::Vertical : Qt::Horizontal;
+	const int itemCount   = randomInt(1, 300);
+	const int minimumRows = randomInt(1, 3);
+
+	QGraphicsWidget *host = new QGraphicsWidget();
+	LimitSqueezeTaskbarLayout *layout = new LimitSqueezeTaskbarLayout(
+		randomReal(0.1, 1.0), qrand() & 1, orientation);
+	QList<TaskItem*> items;
+
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->setSpacing(randomInt(0, 8));
+	layout->setRowBounds(minimumRows, randomInt(minimumRows, minimumRows + 4));
+	layout->setAspectRatio(randomReal(0.5, 2.0));
+	layout->setExpandedWidth(randomInt(0, 250));
+	layout->setAnimationsEnabled(false);
+	host->setLayout(layout);
+
+	const qreal length    = randomInt(100, 2000);
+	const qreal thickness = randomInt(16, 120);
+
+	if (orientation == Qt::Vertical) {
+		host->resize(thickness, length);
+	}
+	else {
+		host->resize(length, thickness);
+	}
+
+	for (int index = 0; index < itemCount; ++ index) {
+		TaskItem *item = new TaskItem(Task::TaskItem, 1, host);
+
+		// some items are expanded, some of them by hovering
+		if (qrand() % 3 == 0) {
+			item->setExpanded(true, qrand() % 4 == 0);
+		}
+		items.append(item);
+		layout->addItem(item, item->isExpanded());
+	}
+
+	QApplication::sendPostedEvents(host, QEvent::LayoutRequest);
+	layout->activate();
+
+	const LimitSqueezeReference reference(layout, items);
+	const QSizeF preferredSize(layout->preferredSize());
+	const qreal  preferredWidth = orientation == Qt::Vertical ?
+		preferredSize.height() : preferredSize.width();
+	bool ok = layout->rows() == reference.rows() &&
+		preferredWidth == reference.maxPreferredRowWidth();
+
+	for (int index = 0; ok && index < itemCount; ++ index) {
+		ok = layout->rowOf(index) == reference.rowOf(index);
+	}
+
+	if (!ok) {
+		std::fprintf(stderr, "FAIL: case %d with %d items: %d rows, expected %d rows\n",
+			testCase, itemCount, layout->rows(), reference.rows());
+	}
+
+	// deletes the layout and the items
+	delete host;
+
+	return ok;
+}
+
+// Lays out either the tasks or the items of the grouped tasks, like the group
+// manager does with "only group when full".
+void setGrouped(QGraphicsWidget *host, TaskbarLayout *layout, const QList<TaskItem*>& items) {
+	layout->clear();
+	foreach (TaskItem *item, items) {
+		layout->addItem(item, false);
+	}
+
+	QApplication::sendPostedEvents(host, QEvent::LayoutRequest);
+	layout->activate();
+}
+
+// returns false if the tasks of a randomized LimitSqueeze layout are grouped
+// and ungrouped again and again
+bool checkCapacity(int testCase) {
+	const int STEPS   = 60;  // 15 seconds, several dwell times
+	const int STEP_MS = 250;
+	const Qt::Orientation orientation = qrand() & 1 ? Qt::Vertical : Qt::Horizontal;
+	const int minimumRows = randomInt(1, 2);
+
+	QGraphicsWidget *host = new QGraphicsWidget();
+	LimitSqueezeTaskbarLayout *layout = new LimitSqueezeTaskbarLayout(
+		randomReal(0.3, 1.0), qrand() & 1, orientation);
+	QList<TaskItem*> tasks;
+	QList<TaskItem*> grouped;
+
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->setSpacing(randomInt(0, 8));
+	layout->setRowBounds(minimumRows, randomInt(minimumRows, minimumRows + 2));
+	layout->setAspectRatio(randomReal(0.5, 2.0));
+	layout->setAnimationsEnabled(false);
+	host->setLayout(layout);
+
+	const qreal length    = randomInt(100, 2000);
+	const qreal thickness = randomInt(16, 120);
+
+	if (orientation == Qt::Vertical) {
+		host->resize(thickness, length);
+	}
+	else {
+		host->resize(length, thickness);
+	}
+
+	// tasks of the same application are grouped together
+	for (int applications = randomInt(1, 60); applications > 0; -- applications) {
+		const int taskCount = randomInt(1, 4);
+
+		for (int task = 0; task < taskCount; ++ task) {
+			tasks.append(new TaskItem(Task::TaskItem, 1, host));
+		}
+		grouped.append(taskCount > 1 ?
+			new TaskItem(Task::GroupItem, taskCount, host) :
+			tasks.last());
+	}
+
+	VirtualClock       clock;
+	CapacityController controller;
+	controller.setClock(&clock);
+
+	setGrouped(host, layout, tasks);
+	for (int step = 0; step < STEPS; ++ step) {
+		const bool wasFull = controller.isFull();
+
+		controller.propose(layout->optimumCapacity(), layout->count(),
+			layout->ungroupedCompression());
+		if (step == 0 || controller.isFull() != wasFull) {
+			setGrouped(host, layout, controller.isFull() ? grouped : tasks);
+		}
+		clock.advance(STEP_MS);
+	}
+
+	const bool ok = controller.flipCount() <= 1;
+
+	if (!ok) {
+		std::fprintf(stderr, "FAIL: case %d with %d tasks: regrouped %d times, %d suppressed\n",
+			testCase, tasks.size(), controller.flipCount(), controller.suppressedCount());
+	}
+
+	// deletes the layout and all items, grouped or not
+	delete host;
+
+	return ok;
+}
+
+void report(const char *layout, int itemCount, const char *operation, int iterations, double usecs) {
+	std::printf("%s\t%d\t%s\t%d\t%.3f\n", layout, itemCount, operation, iterations, usecs);
+	std::fflush(stdout);
+}
+
+void run(const Case& layoutCase, int itemCount, const Options& options) {
+	Fixture fixture(layoutCase.type, layoutCase.orientation, itemCount);
+	const char *name = layoutCase.label.constData();
+	int iterations = 0;
+	double usecs;
+
+	fixture.layout->setPixelSnapping(options.pixelSnapping);
+	fixture.settle();
+
+	usecs = measure(fixture, doLayout, options.minTime, iterations);
+	report(name, itemCount, "doLayout", iterations, usecs);
+
+	usecs = measure(fixture, expandAt, options.minTime, iterations);
+	report(name, itemCount, "expandAt", iterations, usecs);
+	fixture.layout->skipAnimation();
+	fixture.settle();
+
+	TaskItem *dragged = fixture.items[itemCount / 2];
+	fixture.layout->beginDrag(dragged, dragged->geometry().center());
+	usecs = measure(fixture, moveDraggedItem, options.minTime, iterations);
+	report(name, itemCount, "moveDraggedItem", iterations, usecs);
+	fixture.layout->endDrag(fixture.layout->currentDragIndex());
+	fixture.layout->skipAnimation();
+	fixture.settle();
+
+	usecs = measure(fixture, itemAt, options.minTime, iterations);
+	report(name, itemCount, "itemAt", iterations, usecs);
+
+	usecs = measure(fixture, animate, options.minTime, iterations);
+	report(name, itemCount, "animate", iterations, usecs);
+	fixture.layout->skipAnimation();
+
+	usecs = measure(fixture, reload, options.minTime, iterations);
+	report(name, itemCount, "reload", iterations, usecs);
+}
+
+void usage(const char *argv0) {
+	std::fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --layout NAME      only run the given layout (may be repeated):\n"
+		"                     ByShape, MaxSqueeze, FixedItemCount, FixedSize, LimitSqueeze\n"
+		"  --max-items N      largest item count to measure (default: 5000)\n"
+		"  --min-time MSECS   time spent per measurement (default: 200)\n"
+		"  --vertical         lay out a vertical panel\n"
+		"  --rtl              use a right-to-left layout direction\n"
+		"  --all-directions   run every layout in all four orientations and directions\n"
+		"  --check-allocations\n"
+		"                     fail if a steady state layout pass allocates memory\n"
+		"  --check-rows       fail if the rows of LimitSqueeze differ from the\n"
+		"                     reference algorithm on randomized inputs\n"
+		"  --check-capacity   fail if LimitSqueeze keeps grouping and ungrouping\n"
+		"                     randomized tasks beyond the minimum dwell time\n"
+		"  --count-geometry   count the item geometries set and skipped per pass\n"
+		"  --pixel-snapping   snap the item destinations to whole pixels\n",
+		argv0);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+	// no GUI: the items are never painted, so no X server is needed
+	QApplication app(argc, argv, false);
+	QStringList  args(app.arguments());
+	Options      options;
+
+	for (int index = 1; index < args.size(); ++ index) {
+		const QString& arg = args[index];
+		bool ok = true;
+
+		if (arg == "--layout" && index + 1 < args.size()) {
+			options.layouts.append(args[++ index]);
+		}
+		else if (arg == "--max-items" && index + 1 < args.size()) {
+			options.maxItems = args[++ index].toInt(&ok);
+		}
+		else if (arg == "--min-time" && index + 1 < args.size()) {
+			options.minTime = args[++ index].toInt(&ok);
+		}
+		else if (arg == "--vertical") {
+			options.orientation = Qt::Vertical;
+		}
+		else if (arg == "--rtl") {
+			options.layoutDirection = Qt::RightToLeft;
+		}
+		else if (arg == "--all-directions") {
+			options.allDirections = true;
+		}
+		else if (arg == "--check-allocations") {
+			options.checkAllocations = true;
+		}
+		else if (arg == "--check-rows") {
+			options.checkRows = true;
+		}
+		else if (arg == "--check-capacity") {
+			options.checkCapacity = true;
+		}
+		else if (arg == "--count-geometry") {
+			options.countGeometry = true;
+		}
+		else if (arg == "--pixel-snapping") {
+			options.pixelSnapping = true;
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (options.checkAllocations && !AllocationCounter::isSupported()) {
+		std::fprintf(stderr, "%s: counting allocations is not supported on this platform\n", argv[0]);
+		return 1;
+	}
+
+	if (options.checkRows) {
+		const int CASES = 2000;
+		int failed = 0;
+
+		// always the same inputs, so failures can be reproduced
+		qsrand(1);
+		for (int testCase = 0; testCase < CASES; ++ testCase) {
+			if (!checkRows(testCase)) {
+				++ failed;
+			}
+		}
+
+		std::printf("%d of %d cases differ from the reference\n", failed, CASES);
+		return failed == 0 ? 0 : 1;
+	}
+
+	if (options.checkCapacity) {
+		const int CASES = 2000;
+		int failed = 0;
+
+		// always the same inputs, so failures can be reproduced
+		qsrand(1);
+		for (int testCase = 0; testCase < CASES; ++ testCase) {
+			if (!checkCapacity(testCase)) {
+				++ failed;
+			}
+		}
+
+		std::printf("%d of %d cases keep regrouping\n", failed, CASES);
+		return failed == 0 ? 0 : 1;
+	}
+
+	if (options.checkAllocations) {
+		std::printf("# layout\titems\toperation\tallocations\n");
+	}
+	else if (options.countGeometry) {
+		std::printf("# layout\titems\toperation\tset/op\tskipped/op\n");
+	}
+	else {
+		std::printf("# layout\titems\toperation\titerations\tusec/op\n");
+	}
+
+	QList<Case> cases;
+
+	for (int layout = 0; layout < LAYOUTS_SIZE; ++ layout) {
+		if (!options.layouts.isEmpty() && !options.layouts.contains(LAYOUTS[layout].name)) {
+			continue;
+		}
+
+		Case layoutCase;
+		layoutCase.type = LAYOUTS[layout].type;
+
+		if (options.allDirections) {
+			for (int direction = 0; direction < DIRECTIONS_SIZE; ++ direction) {
+				layoutCase.orientation     = DIRECTIONS[direction].orientation;
+				layoutCase.layoutDirection = DIRECTIONS[direction].layoutDirection;
+				layoutCase.label           = QByteArray(LAYOUTS[layout].name) + '/' + DIRECTIONS[direction].name;
+				cases.append(layoutCase);
+			}
+		}
+		else {
+			layoutCase.orientation     = options.orientation;
+			layoutCase.layoutDirection = options.layoutDirection;
+			layoutCase.label           = LAYOUTS[layout].name;
+			cases.append(layoutCase);
+		}
+	}
+
+	bool ok = true;
+
+	foreach (const Case& layoutCase, cases) {
+		// the layouts read the direction from the application
+		QApplication::setLayoutDirection(layoutCase.layoutDirection);
+
+		for (int count = 0; count < ITEM_COUNTS_SIZE && ITEM_COUNTS[count] <= options.maxItems; ++ count) {
+			if (options.checkAllocations) {
+				if (!checkAllocations(layoutCase, ITEM_COUNTS[count])) {
+					std::fprintf(stderr, "FAIL: %s with %d items allocates during layout passes\n",
+						layoutCase.label.constData(), ITEM_COUNTS[count]);
+					ok = false;
+				}
+			}
+			else if (options.countGeometry) {
+				countGeometry(layoutCase, ITEM_COUNTS[count], options);
+			}
+			else {
+				run(layoutCase, ITEM_COUNTS[count], options);
+			}
+		}
+	}
+
+	return ok ? 0 : 1;
+}
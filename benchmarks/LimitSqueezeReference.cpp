@@ -0,0 +1,144 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Smooth Tasks
+#include "LimitSqueezeReference.h"
+#include "SmoothTasks/TaskItem.h"
+#include "SmoothTasks/LimitSqueezeTaskbarLayout.h"
+
+namespace SmoothTasks {
+
+LimitSqueezeReference::LimitSqueezeReference(const LimitSqueezeTaskbarLayout *layout, const QList<TaskItem*>& items)
+		: m_rows(0),
+		  m_rowOf(items.size(), -1),
+		  m_maxPreferredRowWidth(0.0) {
+	const bool isVertical = layout->orientation() == Qt::Vertical;
+	const int  N          = items.size();
+
+	if (N == 0) {
+		m_rows = 1;
+		return;
+	}
+
+	qreal left = 0, top = 0, right = 0, bottom = 0;
+	layout->getContentsMargins(&left, &top, &right, &bottom);
+
+	const QRectF effectiveRect(layout->geometry().adjusted(left, top, -right, -bottom));
+	const qreal availableWidth  = isVertical ? effectiveRect.height() : effectiveRect.width();
+	const qreal availableHeight = isVertical ? effectiveRect.width()  : effectiveRect.height();
+	const qreal spacing         = layout->spacing();
+	const qreal expandedWidth   = layout->expandedWidth();
+	const qreal squeezeRatio    = layout->squeezeRatio();
+
+#define CELL_HEIGHT(ROWS) (((availableHeight + spacing) / ((qreal) (ROWS))) - spacing)
+
+	int rows = layout->minimumRows() - 1;
+
+	qreal cellHeight = 0.0;
+	qreal cellWidth  = 0.0;
+
+	qreal compression            = 1.0;
+	qreal thisRowWidth           = 0.0;
+	int   expandedHoverItemCount = 0;
+	int   expandedItemCount      = 0;
+
+	for (int index = 0; index < N; ++ index) {
+		if (items[index]->isExpandedByHover()) {
+			++ expandedHoverItemCount;
+		}
+
+		if (items[index]->isExpanded()) {
+			++ expandedItemCount;
+		}
+	}
+
+	while (rows < layout->maximumRows()) {
+		++ rows;
+		cellHeight = CELL_HEIGHT(rows);
+		cellWidth  = cellHeight * layout->aspectRatio();
+		thisRowWidth = N * (cellWidth + spacing) +
+			(expandedItemCount - expandedHoverItemCount) * expandedWidth;
+		compression = qMin((rows * availableWidth) / thisRowWidth, 1.0);
+
+		if (rows * availableWidth > (thisRowWidth - N * cellWidth) * squeezeRatio + N * cellWidth / (rows + 1)) {
+			break;
+		}
+	}
+
+#undef CELL_HEIGHT
+
+	int startIndex = 0;
+	int endIndex   = 0;
+	int index      = 0;
+	int rowCount   = 0;
+
+	for (int row = 0; row < rows && endIndex < N; ++ row) {
+		startIndex = endIndex;
+
+		expandedHoverItemCount = 0;
+		expandedItemCount      = 0;
+		for (index = startIndex; index < N; ++ index) {
+			if (items[index]->isExpandedByHover()) {
+				++ expandedHoverItemCount;
+			}
+
+			if (items[index]->isExpanded()) {
+				++ expandedItemCount;
+			}
+
+			thisRowWidth = (index - startIndex) * (cellWidth + spacing) +
+				(expandedItemCount - expandedHoverItemCount) * expandedWidth;
+			if (availableWidth < compression * thisRowWidth * 0.9) {
+				break;
+			}
+		}
+
+		if (row + 1 == rows) {
+			endIndex = N;
+		}
+		else {
+			if (startIndex == index) {
+				++ index;
+			}
+
+			endIndex = qMin(N, index);
+		}
+
+		qreal rowSpacing = spacing * (endIndex - startIndex);
+		thisRowWidth = 0.0;
+
+		for (int index = startIndex; index < endIndex; ++ index) {
+			thisRowWidth += cellWidth + (items[index]->isExpanded() ? expandedWidth : 0.0);
+			m_rowOf[index] = rowCount;
+		}
+
+		if (thisRowWidth + rowSpacing > m_maxPreferredRowWidth) {
+			m_maxPreferredRowWidth = thisRowWidth + rowSpacing;
+		}
+
+		if (startIndex != endIndex) {
+			++ rowCount;
+		}
+	}
+
+	m_rows = qMax(layout->minimumRows(), rowCount);
+}
+
+} // namespace SmoothTasks
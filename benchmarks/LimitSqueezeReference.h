@@ -0,0 +1,54 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// The row distribution of LimitSqueezeTaskbarLayout like it was computed before
+// the row solver: item by item, asking every item whether it is expanded.
+// LayoutBenchmark --check-rows compares the layout against it.
+
+#ifndef SMOOTHTASKS_LIMITSQUEEZEREFERENCE_H
+#define SMOOTHTASKS_LIMITSQUEEZEREFERENCE_H
+
+// Qt
+#include <QList>
+#include <QVector>
+
+namespace SmoothTasks {
+
+class LimitSqueezeTaskbarLayout;
+class TaskItem;
+
+class LimitSqueezeReference {
+
+public:
+	// uses the geometry and the parameters of the layout
+	LimitSqueezeReference(const LimitSqueezeTaskbarLayout *layout, const QList<TaskItem*>& items);
+
+	int   rows()                 const { return m_rows; }
+	int   rowOf(int index)       const { return m_rowOf[index]; }
+	qreal maxPreferredRowWidth() const { return m_maxPreferredRowWidth; }
+
+private:
+	int          m_rows;
+	QVector<int> m_rowOf;
+	qreal        m_maxPreferredRowWidth;
+};
+
+} // namespace SmoothTasks
+#endif
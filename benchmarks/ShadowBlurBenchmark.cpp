@@ -0,0 +1,334 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Headless benchmark for the text shadow blur.
+//
+// Label sized images with text like alpha are blurred the way
+// Plasma::PaintUtils::shadowBlur() does it and with ShadowBlur. PaintUtils
+// is not linked, the reference is a copy of its expblur<16, 7> followed by
+// the same fill in CompositionMode_SourceIn:
+//
+//   reference   expblur() on all four channels, then the fill
+//   scalar      the blur of the alpha channel with blurColumnsScalar()
+//   sse2        the same with blurColumnsSse2()
+//   apply       ShadowBlur::apply() like the applet calls it
+//
+// The results of apply() are compared to the reference, and the benchmark
+// fails if they differ.
+//
+// The output is tab separated so runs can be diffed or fed into a spreadsheet:
+//
+//   smooth-tasks-blurbench --min-time 500
+
+// Smooth Tasks
+#include "SmoothTasks/ShadowBlur.h"
+
+// Qt
+#include <QApplication>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QStringList>
+#include <QVector>
+
+// STD C++
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SmoothTasks;
+
+namespace {
+
+// the radius the applet uses
+const int RADIUS = 2;
+
+struct Size {
+	int width;
+	int height;
+};
+
+const Size SIZES[] = {
+	{ 200, 20 },
+	{ 300, 30 },
+	{ 400, 40 }
+};
+
+const int SIZES_SIZE = sizeof(SIZES) / sizeof(SIZES[0]);
+
+// An image that looks like a line of text to the blur: runs of opaque and
+// antialiased pixels on a transparent background.
+QImage createLabel(const Size& size) {
+	QImage image(size.width, size.height, QImage::Format_ARGB32_Premultiplied);
+	image.fill(0);
+
+	const int top    = size.height / 4;
+	const int bottom = size.height - size.height / 4;
+
+	for (int y = top; y < bottom; ++ y) {
+		QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+		for (int x = 2; x < size.width - 2; ++ x) {
+			if (qrand() % 3 == 0) {
+				const int alpha = qrand() % 4 == 0 ? qrand() % 256 : 255;
+				line[x] = qRgba(alpha, alpha, alpha, alpha);
+			}
+		}
+	}
+
+	return image;
+}
+
+// expblur() and its helpers of kdelibs 4 (plasma/paintutils.cpp and
+// kdeui/util/kimageeffect), the blur behind PaintUtils::shadowBlur().
+template<int aprec, int zprec>
+inline void blurinner(unsigned char *bptr, int &zR, int &zG, int &zB, int &zA, int alpha) {
+	int R, G, B, A;
+	R = *bptr;
+	G = *(bptr + 1);
+	B = *(bptr + 2);
+	A = *(bptr + 3);
+
+	zR += (alpha * ((R << zprec) - zR)) >> aprec;
+	zG += (alpha * ((G << zprec) - zG)) >> aprec;
+	zB += (alpha * ((B << zprec) - zB)) >> aprec;
+	zA += (alpha * ((A << zprec) - zA)) >> aprec;
+
+	*bptr =     zR >> zprec;
+	*(bptr+1) = zG >> zprec;
+	*(bptr+2) = zB >> zprec;
+	*(bptr+3) = zA >> zprec;
+}
+
+template<int aprec, int zprec>
+void blurrow(QImage &im, int line, int alpha) {
+	int zR, zG, zB, zA;
+
+	QRgb *ptr = (QRgb *)im.scanLine(line);
+	int width = im.width();
+
+	zR = *((unsigned char *)ptr    ) << zprec;
+	zG = *((unsigned char *)ptr + 1) << zprec;
+	zB = *((unsigned char *)ptr + 2) << zprec;
+	zA = *((unsigned char *)ptr + 3) << zprec;
+
+	for (int index = 1; index < width; index++) {
+		blurinner<aprec, zprec>((unsigned char *)&ptr[index], zR, zG, zB, zA, alpha);
+	}
+	for (int index = width - 2; index >= 0; index--) {
+		blurinner<aprec, zprec>((unsigned char *)&ptr[index], zR, zG, zB, zA, alpha);
+	}
+}
+
+template<int aprec, int zprec>
+void blurcol(QImage &im, int col, int alpha) {
+	int zR, zG, zB, zA;
+
+	QRgb *ptr = (QRgb *)im.bits();
+	ptr += col;
+	int height = im.height();
+	int width = im.width();
+
+	zR = *((unsigned char *)ptr    ) << zprec;
+	zG = *((unsigned char *)ptr + 1) << zprec;
+	zB = *((unsigned char *)ptr + 2) << zprec;
+	zA = *((unsigned char *)ptr + 3) << zprec;
+
+	for (int index = width; index < (height - 1) * width; index += width) {
+		blurinner<aprec, zprec>((unsigned char *)&ptr[index], zR, zG, zB, zA, alpha);
+	}
+	for (int index = (height - 2) * width; index >= 0; index -= width) {
+		blurinner<aprec, zprec>((unsigned char *)&ptr[index], zR, zG, zB, zA, alpha);
+	}
+}
+
+template<int aprec, int zprec>
+void expblur(QImage &img, int radius) {
+	if (radius < 1) {
+		return;
+	}
+
+	int alpha = (int)((1 << aprec) * (1.0f - expf(-2.3f / (radius + 1.f))));
+
+	for (int row = 0; row < img.height(); row++) {
+		blurrow<aprec, zprec>(img, row, alpha);
+	}
+
+	for (int col = 0; col < img.width(); col++) {
+		blurcol<aprec, zprec>(img, col, alpha);
+	}
+}
+
+void referenceShadowBlur(QImage& image, int radius, const QColor& color) {
+	expblur<16, 7>(image, radius);
+
+	QPainter painter(&image);
+	painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+	painter.fillRect(image.rect(), color);
+	painter.end();
+}
+
+typedef void (*ColumnKernel)(uchar *alpha, int width, int height, int stride, int factor);
+
+struct Fixture {
+	QImage         label;
+	QImage         image;
+	QVector<uchar> alpha;
+	QVector<uchar> blurred;
+};
+
+// returns microseconds per call
+template<typename Operation>
+double measure(Operation operation, int minTime, int& iterations) {
+	QElapsedTimer timer;
+	iterations = 0;
+	timer.start();
+
+	do {
+		operation();
+		++ iterations;
+	} while (timer.elapsed() < minTime);
+
+	return timer.elapsed() * 1000.0 / iterations;
+}
+
+struct ReferenceOperation {
+	Fixture& fixture;
+	ReferenceOperation(Fixture& fixture) : fixture(fixture) {}
+	void operator () () const {
+		fixture.image = fixture.label;
+		referenceShadowBlur(fixture.image, RADIUS, Qt::black);
+	}
+};
+
+struct KernelOperation {
+	ColumnKernel kernel;
+	Fixture&     fixture;
+	KernelOperation(ColumnKernel kernel, Fixture& fixture) : kernel(kernel), fixture(fixture) {}
+	void operator () () const {
+		const int width  = fixture.label.width();
+		const int height = fixture.label.height();
+		const int factor = ShadowBlur::factorFor(RADIUS);
+
+		fixture.blurred = fixture.alpha;
+		ShadowBlur::blurRows(fixture.blurred.data(), width, height, width, factor);
+		kernel(fixture.blurred.data(), width, height, width, factor);
+	}
+};
+
+struct ApplyOperation {
+	Fixture& fixture;
+	ApplyOperation(Fixture& fixture) : fixture(fixture) {}
+	void operator () () const {
+		fixture.image = fixture.label;
+		ShadowBlur::apply(fixture.image, RADIUS, Qt::black);
+	}
+};
+
+void printRow(const Size& size, const char *kernel, int iterations, double usec) {
+	std::printf("%dx%d\t%s\t%d\t%.2f\n", size.width, size.height, kernel, iterations, usec);
+	std::fflush(stdout);
+}
+
+// returns false if the result differs from the reference
+bool run(const Size& size, int minTime) {
+	Fixture fixture;
+	fixture.label = createLabel(size);
+	fixture.alpha.resize(size.width * size.height);
+
+	for (int y = 0; y < size.height; ++ y) {
+		const QRgb *line = reinterpret_cast<const QRgb*>(fixture.label.constScanLine(y));
+
+		for (int x = 0; x < size.width; ++ x) {
+			fixture.alpha[y * size.width + x] = uchar(qAlpha(line[x]));
+		}
+	}
+
+	int    iterations = 0;
+	double usec       = measure(ReferenceOperation(fixture), minTime, iterations);
+	printRow(size, "reference", iterations, usec);
+	const QImage expected(fixture.image);
+
+	usec = measure(KernelOperation(ShadowBlur::blurColumnsScalar, fixture), minTime, iterations);
+	printRow(size, "scalar", iterations, usec);
+#ifdef __SSE2__
+	usec = measure(KernelOperation(ShadowBlur::blurColumnsSse2, fixture), minTime, iterations);
+	printRow(size, "sse2", iterations, usec);
+#endif
+
+	usec = measure(ApplyOperation(fixture), minTime, iterations);
+	printRow(size, "apply", iterations, usec);
+
+	if (fixture.image != expected) {
+		std::fprintf(stderr, "%dx%d: apply() differs from the reference\n", size.width, size.height);
+		return false;
+	}
+
+	return true;
+}
+
+void usage(const char *argv0) {
+	std::fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --min-time MSECS   time spent per measurement (default: 200)\n",
+		argv0);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+	// no GUI: only images are painted, so no X server is needed
+	QApplication app(argc, argv, false);
+	QStringList  args(app.arguments());
+	int          minTime = 200;
+
+	for (int index = 1; index < args.size(); ++ index) {
+		const QString& arg = args[index];
+		bool ok = true;
+
+		if (arg == "--min-time" && index + 1 < args.size()) {
+			minTime = args[++ index].toInt(&ok);
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// always the same labels, so runs can be compared
+	qsrand(1);
+
+	std::printf("# blurColumns() uses the %s kernel, radius %d\n", ShadowBlur::kernelName(), RADIUS);
+	std::printf("# size\tkernel\titerations\tusec/op\n");
+
+	bool ok = true;
+	for (int size = 0; size < SIZES_SIZE; ++ size) {
+		if (!run(SIZES[size], minTime)) {
+			ok = false;
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "SmoothTasks/TaskItem.h"
+#include "AllocationCounter.h"
+
+namespace SmoothTasks {
+
+TaskItem::TaskItem(Task::ItemType type, int taskCount, QGraphicsItem *parent)
+		: QGraphicsWidget(parent),
+		  m_task(new Task(type, taskCount)),
+		  m_expanded(false),
+		  m_expandedByHover(false),
+		  m_orientation(Qt::Horizontal),
+		  m_cellSize(0, 0) {
+}
+
+TaskItem::~TaskItem() {
+	delete m_task;
+}
+
+void TaskItem::setExpanded(bool expanded, bool byHover) {
+	m_expanded        = expanded;
+	m_expandedByHover = byHover;
+	emit expand(this, expanded ? Expand : Collapse);
+}
+
+void TaskItem::setGeometry(const QRectF& rect) {
+	AllocationCounter::Suspender suspender;
+	QGraphicsWidget::setGeometry(rect);
+}
+
+void TaskItem::setOrientation(Qt::Orientation orientation) {
+	m_orientation = orientation;
+}
+
+void TaskItem::setCellSize(const QSizeF& cellSize) {
+	m_cellSize = cellSize;
+}
+
+} // namespace SmoothTasks
+#include "TaskItem.moc"
@@ -0,0 +1,75 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Stand-in for applet/SmoothTasks/TaskItem.h used by the headless benchmarks.
+// It is a plain QGraphicsWidget, so geometry updates cost what they cost in the
+// applet, but it does not paint and needs neither Plasma nor a running X server.
+
+#ifndef SMOOTHTASKS_TASKITEM_H
+#define SMOOTHTASKS_TASKITEM_H
+
+// Smooth Tasks
+#include "SmoothTasks/Task.h"
+#include "SmoothTasks/ExpansionDirection.h"
+
+// Qt
+#include <QGraphicsWidget>
+#include <QRectF>
+#include <QSizeF>
+
+namespace SmoothTasks {
+
+class TaskItem : public QGraphicsWidget {
+	Q_OBJECT
+
+public:
+	TaskItem(Task::ItemType type, int taskCount, QGraphicsItem *parent = NULL);
+	~TaskItem();
+
+	Task *task() const { return m_task; }
+	bool  isExpanded() const { return m_expanded; }
+	bool  isExpandedByHover() const { return m_expanded && m_expandedByHover; }
+
+	Qt::Orientation orientation() const { return m_orientation; }
+	const QSizeF&   cellSize() const { return m_cellSize; }
+
+	void setExpanded(bool expanded, bool byHover = false);
+
+	// What QGraphicsWidget does on a geometry change is not counted as
+	// allocations of the layout (see --check-allocations).
+	virtual void setGeometry(const QRectF& rect);
+
+public slots:
+	void setOrientation(Qt::Orientation orientation);
+	void setCellSize(const QSizeF& cellSize);
+
+private:
+	Task           *m_task;
+	bool            m_expanded;
+	bool            m_expandedByHover;
+	Qt::Orientation m_orientation;
+	QSizeF          m_cellSize;
+
+signals:
+	void expand(TaskItem* item, ExpansionDirection direction);
+};
+
+} // namespace SmoothTasks
+#endif
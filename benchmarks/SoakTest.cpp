@@ -0,0 +1,581 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+// Soak test for the animations of the task items.
+//
+// Hours of synthetic state churn are replayed against the items within a
+// minute or so: windows demand attention and stop again, get minimized and
+// focused, are hovered, which expands and collapses them, and tasks are closed
+// and started. A virtual clock drives the AnimationDriver and the layout one
+// frame per tick, so a run does not depend on the speed of the machine. The
+// driver only ticks while its timer runs, like in the event loop, and every
+// tick is counted by the WakeupMonitor.
+//
+// Every --report-minutes of simulated time a tab separated line is printed:
+//
+//   minutes      simulated time
+//   items        task items
+//   connections  signal connections of all objects involved
+//   peak         most connections of a single object
+//   tracks       running tracks of the AnimationDriver
+//   timers       active timers
+//   fps          frames that repainted something in the last second
+//   coalesced    repaint requests coalesced in the last second
+//   rss          resident set size in KiB, -1 where unknown
+//
+// These have to stay flat. The test fails if the peak connections grow after
+// the first report, or if there are more tracks or timers than the items can
+// have. The RSS is only reported, the allocator makes it too noisy to judge.
+//
+// After the churn all items calm down, no attention, hover or startup. Once
+// their animations are finished the test fails if anything still wakes up
+// within IDLE_SECONDS.
+//
+// SoakItem repeats what TaskItem does with its animations (see
+// TaskItem::updateState()), the animations themselves are the real ones: the
+// Light, TaskStateAnimation, the layout, the RepaintScheduler and the driver.
+// TaskIcon needs Plasma, so its startup animation is run as the
+// PulseAnimation TaskIcon::startStartupAnimation() restarts. Run e.g.:
+//
+//   smooth-tasks-soak --hours 8 --items 40
+
+// Smooth Tasks
+#include "VirtualClock.h"
+#include "SmoothTasks/AnimationDriver.h"
+#include "SmoothTasks/Light.h"
+#include "SmoothTasks/PulseAnimation.h"
+#include "SmoothTasks/RepaintScheduler.h"
+#include "SmoothTasks/TaskItem.h"
+#include "SmoothTasks/TaskStateAnimation.h"
+#include "SmoothTasks/LimitSqueezeTaskbarLayout.h"
+#include "SmoothTasks/WakeupMonitor.h"
+
+// Qt
+#include <QApplication>
+#include <QGraphicsWidget>
+#include <QMetaMethod>
+#include <QStringList>
+#include <QTimer>
+
+// STD C++
+#include <cstdio>
+
+// POSIX
+#include <unistd.h>
+
+using namespace SmoothTasks;
+
+namespace {
+
+const int FPS                = 25;
+const int ANIMATION_DURATION = 175;
+
+// state animation, light and icon
+const int TRACKS_PER_ITEM = 3;
+
+// after the churn: time for the animations to finish, then time that has to
+// pass without any wakeup
+const int SETTLE_SECONDS = 2;
+const int IDLE_SECONDS   = 60;
+
+// The animation side of a TaskItem.
+class SoakItem : public QObject {
+	Q_OBJECT
+
+public:
+	SoakItem(TaskItem *item, RepaintScheduler *scheduler, bool startup, QObject *parent)
+			: QObject(parent),
+			  m_item(item),
+			  m_scheduler(scheduler),
+			  m_light(new Light(this)),
+			  m_icon(new PulseAnimation(this)),
+			  m_stateAnimation(),
+			  m_lights(true),
+			  m_mouseIn(false),
+			  m_attention(false),
+			  m_minimized(false),
+			  m_active(false) {
+		connect(m_icon, SIGNAL(update()), this, SLOT(update()));
+		updateState();
+		connect(m_light, SIGNAL(update()), this, SLOT(update()));
+		connect(&m_stateAnimation, SIGNAL(update()), this, SLOT(update()));
+
+		if (startup) {
+			m_icon->start(500, FPS, true);
+			m_light->startAnimation(Light::StartupAnimation, FPS, 500, true);
+		}
+	}
+
+	~SoakItem() {
+		m_scheduler->cancel(m_item);
+	}
+
+	TaskItem *item() const { return m_item; }
+
+	// not a child, so findChildren() does not see it
+	const TaskStateAnimation *stateAnimation() const { return &m_stateAnimation; }
+
+	void setLights(bool lights) {
+		m_lights = lights;
+
+		// TaskItem::settingsChanged()
+		if (!m_lights) {
+			m_light->stopAnimation();
+		}
+		else if (m_attention) {
+			m_light->startAnimation(Light::AttentionAnimation, FPS, 900, true);
+		}
+	}
+
+	void toggleAttention() { m_attention = !m_attention; updateState(); }
+	void toggleMinimized() { m_minimized = !m_minimized; updateState(); }
+	void setActive(bool active) { m_active = active; updateState(); }
+
+	void toggleHover() {
+		m_mouseIn = !m_mouseIn;
+		m_item->setExpanded(m_mouseIn, true);
+		updateState();
+	}
+
+	// no attention and not hovered, which also ends the startup animation
+	void calmDown() {
+		m_attention = false;
+		if (m_mouseIn) {
+			toggleHover();
+		}
+		else {
+			updateState();
+		}
+	}
+
+public slots:
+	void updateState() {
+		int newState = m_mouseIn ? TaskStateAnimation::Hover : TaskStateAnimation::Normal;
+		m_icon->stop();
+		m_light->stopAnimation();
+
+		if (m_attention) {
+			newState |= TaskStateAnimation::Attention;
+			if (m_lights) {
+				m_light->startAnimation(Light::AttentionAnimation, FPS, 900, true);
+			}
+		}
+		else if (m_minimized) {
+			newState |= TaskStateAnimation::Minimized;
+		}
+		else if (m_active) {
+			newState |= TaskStateAnimation::Focus;
+		}
+
+		m_stateAnimation.setState(newState, FPS, ANIMATION_DURATION);
+	}
+
+	void update() {
+		m_scheduler->schedule(m_item);
+	}
+
+private:
+	TaskItem           *m_item;
+	RepaintScheduler   *m_scheduler;
+	Light              *m_light;
+	PulseAnimation     *m_icon; // of the TaskIcon
+	TaskStateAnimation  m_stateAnimation;
+	bool                m_lights;
+	bool                m_mouseIn;
+	bool                m_attention;
+	bool                m_minimized;
+	bool                m_active;
+};
+
+// QObject::receivers() is protected.
+class ReceiverProbe : public QObject {
+
+public:
+	static int connections(const QObject *object) {
+		const ReceiverProbe *probe = static_cast<const ReceiverProbe*>(object);
+		const QMetaObject   *meta  = object->metaObject();
+		const int N = meta->methodCount();
+		int count = 0;
+
+		for (int index = 0; index < N; ++ index) {
+			const QMetaMethod method(meta->method(index));
+
+			if (method.methodType() == QMetaMethod::Signal) {
+				// what the SIGNAL() macro would make of it
+				count += probe->receivers((QByteArray("2") + method.signature()).constData());
+			}
+		}
+
+		return count;
+	}
+};
+
+struct Options {
+	Options()
+		: hours(4),
+		  items(40),
+		  reportMinutes(30),
+		  eventsPerMinute(30),
+		  seed(1) {}
+
+	int hours;
+	int items;
+	int reportMinutes;
+	int eventsPerMinute;
+	int seed;
+};
+
+struct Sample {
+	Sample()
+		: connections(0),
+		  peak(0),
+		  tracks(0),
+		  timers(0),
+		  fps(0),
+		  coalesced(0) {}
+
+	int connections;
+	int peak;
+	int tracks;
+	int timers;
+	int fps;
+	int coalesced;
+};
+
+class Soak {
+
+public:
+	explicit Soak(const Options& options)
+			: m_options(options),
+			  m_clock(),
+			  m_host(new QGraphicsWidget()),
+			  m_layout(new LimitSqueezeTaskbarLayout(0.6, false, Qt::Horizontal)),
+			  m_root(),
+			  m_scheduler(new RepaintScheduler(&m_root)),
+			  m_items(),
+			  m_active(NULL),
+			  m_lights(true) {
+		AnimationDriver::self()->setClock(&m_clock);
+		m_scheduler->setFps(FPS);
+
+		m_layout->setContentsMargins(0, 0, 0, 0);
+		m_layout->setSpacing(5);
+		m_layout->setRowBounds(1, 3);
+		m_layout->setExpandedWidth(175);
+		m_layout->setExpandDuration(ANIMATION_DURATION);
+		m_layout->setFps(FPS);
+		m_layout->setAnimationClock(&m_clock);
+		m_host->setLayout(m_layout);
+		m_host->resize(1600, 58);
+
+		for (int index = 0; index < m_options.items; ++ index) {
+			addItem(false);
+		}
+	}
+
+	~Soak() {
+		// deletes the layout and the items
+		delete m_host;
+		AnimationDriver::self()->setClock(NULL);
+	}
+
+	qint64 now() const { return m_clock.now(); }
+
+	void frame() {
+		m_clock.advance(1000 / FPS);
+
+		foreach (QTimer *timer, AnimationDriver::self()->findChildren<QTimer*>()) {
+			if (timer->isActive()) {
+				QMetaObject::invokeMethod(timer, "timeout");
+			}
+		}
+
+		QApplication::sendPostedEvents(m_host, QEvent::LayoutRequest);
+		m_layout->activate();
+	}
+
+	void churn() {
+		const int index = qrand() % m_items.size();
+		SoakItem *item  = m_items[index];
+
+		switch (qrand() % 6) {
+		case 0:
+			item->toggleAttention();
+			break;
+
+		case 1:
+			item->toggleMinimized();
+			break;
+
+		case 2:
+			if (m_active != NULL) {
+				m_active->setActive(false);
+			}
+			m_active = item;
+			m_active->setActive(true);
+			break;
+
+		case 3:
+			item->toggleHover();
+			break;
+
+		case 4:
+			// a task is closed and another one started
+			removeItem(index);
+			addItem(true);
+			break;
+
+		case 5:
+			m_lights = !m_lights;
+			foreach (SoakItem *other, m_items) {
+				other->setLights(m_lights);
+			}
+			break;
+		}
+	}
+
+	Sample sample() const {
+		Sample sample;
+		QList<const QObject*> objects;
+
+		objects.append(AnimationDriver::self());
+		objects.append(m_layout);
+		objects.append(m_host);
+
+		foreach (const SoakItem *item, m_items) {
+			objects.append(item->item());
+			objects.append(item->stateAnimation());
+		}
+
+		foreach (const QObject *object, m_root.findChildren<QObject*>()) {
+			objects.append(object);
+		}
+
+		foreach (const QObject *object, objects) {
+			const int connections = ReceiverProbe::connections(object);
+			sample.connections += connections;
+			sample.peak = qMax(sample.peak, connections);
+		}
+
+		foreach (const QTimer *timer, m_root.findChildren<QTimer*>()) {
+			if (timer->isActive()) {
+				++ sample.timers;
+			}
+		}
+
+		foreach (const QTimer *timer, AnimationDriver::self()->findChildren<QTimer*>()) {
+			if (timer->isActive()) {
+				++ sample.timers;
+			}
+		}
+
+		sample.tracks    = AnimationDriver::self()->trackCount();
+		sample.fps       = m_scheduler->framesLastSecond();
+		sample.coalesced = m_scheduler->coalescedLastSecond();
+
+		return sample;
+	}
+
+	int itemCount() const { return m_items.size(); }
+
+	void calmDown() {
+		foreach (SoakItem *item, m_items) {
+			item->calmDown();
+		}
+	}
+
+private:
+	void addItem(bool startup) {
+		TaskItem *item = new TaskItem(Task::TaskItem, 1, m_host);
+		m_layout->addItem(item, false);
+		m_items.append(new SoakItem(item, m_scheduler, startup, &m_root));
+	}
+
+	void removeItem(int index) {
+		SoakItem *item = m_items.takeAt(index);
+
+		if (m_active == item) {
+			m_active = NULL;
+		}
+
+		m_layout->removeItem(item->item());
+		delete item->item();
+		delete item;
+	}
+
+	Options           m_options;
+	VirtualClock      m_clock;
+	QGraphicsWidget  *m_host;
+	TaskbarLayout    *m_layout;
+	QObject           m_root; // parent of the SoakItems and the scheduler
+	RepaintScheduler *m_scheduler;
+	QList<SoakItem*>  m_items;
+	SoakItem         *m_active;
+	bool              m_lights;
+};
+
+// in KiB
+long residentSetSize() {
+	std::FILE *file = std::fopen("/proc/self/statm", "r");
+	long size     = 0;
+	long resident = -1;
+
+	if (file == NULL) {
+		return -1;
+	}
+
+	if (std::fscanf(file, "%ld %ld", &size, &resident) != 2) {
+		resident = -1;
+	}
+	std::fclose(file);
+
+	return resident < 0 ? -1 : resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void usage(const char *program) {
+	std::fprintf(stderr,
+		"usage: %s [--hours N] [--items N] [--report-minutes N]\n"
+		"       [--events-per-minute N] [--seed N]\n",
+		program);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	// no GUI: the items are never painted, so no X server is needed
+	QApplication app(argc, argv, false);
+	QStringList  args(app.arguments());
+	Options      options;
+
+	for (int index = 1; index < args.size(); ++ index) {
+		const QString& arg = args[index];
+		bool ok = index + 1 < args.size();
+		int  value = ok ? args[index + 1].toInt(&ok) : 0;
+
+		if (ok && arg == "--hours") {
+			options.hours = value;
+		}
+		else if (ok && arg == "--items") {
+			options.items = value;
+		}
+		else if (ok && arg == "--report-minutes") {
+			options.reportMinutes = value;
+		}
+		else if (ok && arg == "--events-per-minute") {
+			options.eventsPerMinute = value;
+		}
+		else if (ok && arg == "--seed") {
+			options.seed = value;
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok || value < 0) {
+			usage(argv[0]);
+			return 1;
+		}
+		++ index;
+	}
+
+	if (options.items <= 0 || options.reportMinutes <= 0 || options.eventsPerMinute <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	qsrand(options.seed);
+
+	Soak         soak(options);
+	const qint64 end           = qint64(options.hours) * 60 * 60 * 1000;
+	const qint64 reportPeriod  = qint64(options.reportMinutes) * 60 * 1000;
+	const int    framesPerEvent = qMax(1, FPS * 60 / options.eventsPerMinute);
+	qint64       nextReport    = reportPeriod;
+	bool         first         = true;
+	Sample       warm;
+	int          failures      = 0;
+
+	std::printf("# minutes\titems\tconnections\tpeak\ttracks\ttimers\tfps\tcoalesced\trss\n");
+
+	while (soak.now() < end) {
+		soak.frame();
+
+		if (qrand() % framesPerEvent == 0) {
+			soak.churn();
+		}
+
+		if (soak.now() >= nextReport) {
+			const Sample sample(soak.sample());
+
+			std::printf("%lld\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%ld\n",
+				soak.now() / 60000, soak.itemCount(),
+				sample.connections, sample.peak,
+				sample.tracks, sample.timers,
+				sample.fps, sample.coalesced,
+				residentSetSize());
+			std::fflush(stdout);
+
+			if (first) {
+				warm  = sample;
+				first = false;
+			}
+			else if (sample.peak > warm.peak) {
+				std::printf("# an object gained connections: %d, was %d\n", sample.peak, warm.peak);
+				++ failures;
+			}
+
+			// one track per item and animation, plus the tickers of the
+			// layout and the scheduler
+			if (sample.tracks > soak.itemCount() * TRACKS_PER_ITEM + 2) {
+				std::printf("# too many tracks: %d\n", sample.tracks);
+				++ failures;
+			}
+
+			// the items repaint with the frames, only the driver has a timer
+			if (sample.timers > 1) {
+				std::printf("# too many active timers: %d\n", sample.timers);
+				++ failures;
+			}
+
+			nextReport += reportPeriod;
+		}
+	}
+
+	soak.calmDown();
+	for (const qint64 settled = soak.now() + SETTLE_SECONDS * 1000; soak.now() < settled;) {
+		soak.frame();
+	}
+
+	const qint64 wakeups = WakeupMonitor::self()->total();
+
+	for (const qint64 idle = soak.now() + IDLE_SECONDS * 1000; soak.now() < idle;) {
+		soak.frame();
+	}
+
+	const qint64 idleWakeups = WakeupMonitor::self()->total() - wakeups;
+
+	std::printf("# wakeups while idle: %lld\n", idleWakeups);
+	if (idleWakeups > 0) {
+		++ failures;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
+
+#include "SoakTest.moc"
@@ -0,0 +1,44 @@
+/***********************************************************************************
+* Smooth Tasks
+* Copyright (C) 2026 Smooth Tasks Next contributors
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef SMOOTHTASKS_VIRTUALCLOCK_H
+#define SMOOTHTASKS_VIRTUALCLOCK_H
+
+// Smooth Tasks
+#include "SmoothTasks/AnimationClock.h"
+
+namespace SmoothTasks {
+
+// Only advances when told to, so the animation frames of a run are the same
+// on every machine and do not depend on how long the frames took.
+class VirtualClock : public AnimationClock {
+
+public:
+	VirtualClock() : m_now(0) {}
+
+	qint64 now() const { return m_now; }
+	void   advance(qint64 msecs) { m_now += msecs; }
+
+private:
+	qint64 m_now;
+};
+
+} // namespace SmoothTasks
+#endif